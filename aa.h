@@ -0,0 +1,183 @@
+#ifndef AA_DEFINED
+#define AA_DEFINED
+
+#include "blitter.h"
+#include "simd.h"
+#include "include/GPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/* ========== ANTI-ALIASING ==========
+ * Anti-aliased fills don't sample pixel centers: every line adds, to the cells of each row it
+ * crosses, the signed area it covers to its right within that row (+ going down, - going up).
+ * Summing a row from the left then gives each pixel's exact (signed) coverage, for every line
+ * at once: one pass over the lines and one running sum per row, instead of many samples per
+ * pixel. Coverage is the sum's magnitude clamped to 1: exact for pixels whose regions are wound
+ * 0 or +-1, and nonzero winding inside overlaps; where contours overlap within a pixel it's
+ * their net area (half a pixel wound 2 reads as covered), as with glyph rasterizers.
+ *
+ * The cells are those of the path's box on the device (plus 2 spare columns on the right, for
+ * lines on its right side), so lines are first cut to its rows and clamped to its columns: a
+ * part to the left is moved onto its left side, where it still covers the whole row.
+ */
+
+// cells an anti-aliased fill accumulates at once (16MB): bigger boxes are done in bands of rows
+constexpr int kAACellBudget = 1 << 22;
+
+/* CoverageAccumulator
+ * the cells of a (width x height) box
+ */
+class CoverageAccumulator {
+public:
+    /* constructor */
+    CoverageAccumulator(int width, int height)
+        : fWidth(width), fHeight(height), fStride(width + 2), fCells(size_t(width + 2) * height, 0.0f),
+          fRowLeft(height, width + 2), fRowRight(height, -1) {}
+
+    /* addLine()
+     * accumulate the line from p0 to p1 (in the box's coordinates)
+     */
+    void addLine(GPoint p0, GPoint p1) {
+        if (!std::isfinite(p0.x + p0.y + p1.x + p1.y)) {
+            return;
+        }
+
+        // cut to the box's rows
+        float h = float(fHeight);
+        if (((p0.y <= 0) && (p1.y <= 0)) || ((p0.y >= h) && (p1.y >= h)) || (p0.y == p1.y)) {
+            return;
+        }
+        GPoint top = (p0.y < p1.y) ? p0 : p1;
+        GPoint bottom = (p0.y < p1.y) ? p1 : p0;
+        float dir = (p0.y < p1.y) ? 1.0f : -1.0f;
+        float dxdy = (bottom.x - top.x) / (bottom.y - top.y);
+        if (top.y < 0) {
+            top = {top.x - (top.y * dxdy), 0};
+        }
+        if (bottom.y > h) {
+            bottom = {bottom.x - ((bottom.y - h) * dxdy), h};
+        }
+
+        // split where it crosses the box's sides, and clamp the parts outside onto them
+        float w = float(fWidth);
+        float ts[4] = {0, 1, 1, 1};
+        int count = 1;
+        float dx = bottom.x - top.x;
+        for (float side : {0.0f, w}) {
+            float t = (dx != 0) ? ((side - top.x) / dx) : -1;
+            if ((t > 0) && (t < 1)) {
+                ts[count++] = t;
+            }
+        }
+        std::sort(ts + 1, ts + count);
+        ts[count] = 1;
+
+        for (int i = 0; i < count; i++) {
+            GPoint a = {top.x + (dx * ts[i]), top.y + ((bottom.y - top.y) * ts[i])};
+            GPoint b = {top.x + (dx * ts[i + 1]), top.y + ((bottom.y - top.y) * ts[i + 1])};
+            a.x = std::min(std::max(a.x, 0.0f), w);
+            b.x = std::min(std::max(b.x, 0.0f), w);
+            this->accumulate(a, b, dir);
+        }
+    }
+
+    /* blit()
+     * resolve each row's coverage and blend it through the blitter at (x, y) on the device,
+     * clearing the cells for reuse; only the cells lines touched are resolved (left of them the
+     * sum is 0, and right of them it's back to 0, the path being closed)
+     */
+    void blit(int x, int y, Blitter& blitter) {
+        std::vector<uint8_t> coverage(fWidth);
+        for (int row = 0; row < fHeight; row++) {
+            int left = fRowLeft[row];
+            int right = fRowRight[row];
+            if (left > right) {
+                continue;
+            }
+
+            float* cells = &fCells[size_t(row) * fStride];
+            int count = std::min(right + 1, fWidth) - left;
+            if (count > 0) {
+                accumulate_coverage(cells + left, coverage.data(), count);
+                blitter.blitCoverage(x + left, y + row, count, coverage.data());
+            }
+            std::fill(cells + left, cells + right + 1, 0.0f);
+            fRowLeft[row] = fWidth + 2;
+            fRowRight[row] = -1;
+        }
+    }
+
+private:
+    int fWidth;
+    int fHeight;
+    int fStride;
+    std::vector<float> fCells;
+    std::vector<int> fRowLeft;      // the cells touched on each row, if left <= right
+    std::vector<int> fRowRight;
+
+    /* accumulate()
+     * add the line from top to bottom (top.y < bottom.y, both within the box), wound (dir), a
+     * row at a time: where it stays within one pixel, the area right of it goes to that pixel
+     * and the next; otherwise it's spread over the pixels it crosses, by the area of the
+     * triangle/trapezoid it cuts off in each
+     */
+    void accumulate(GPoint top, GPoint bottom, float dir) {
+        if (!(top.y < bottom.y)) {
+            return;
+        }
+
+        float dxdy = (bottom.x - top.x) / (bottom.y - top.y);
+        float x = top.x;
+        int rowEnd = std::min(int(ceil(bottom.y)), fHeight);
+
+        for (int row = int(top.y); row < rowEnd; row++) {
+            float* cells = &fCells[size_t(row) * fStride];
+            float dy = std::min(float(row + 1), bottom.y) - std::max(float(row), top.y);
+            // (kept within the box: stepping can round past bottom's x, which is on its side)
+            float xnext = std::min(std::max(x + (dxdy * dy), 0.0f), float(fWidth));
+            float d = dy * dir;
+
+            float x0 = std::min(x, xnext);
+            float x1 = std::max(x, xnext);
+            float x0floor = floor(x0);
+            int x0i = int(x0floor);
+            float x1ceil = ceil(x1);
+            int x1i = int(x1ceil);
+            fRowLeft[row] = std::min(fRowLeft[row], x0i);
+            fRowRight[row] = std::max(fRowRight[row], std::max(x1i, x0i + 1));
+
+            if (x1i <= x0i + 1) {
+                // within one pixel: split at the line's middle
+                float xmf = (0.5f * (x + xnext)) - x0floor;
+                cells[x0i] += d - (d * xmf);
+                cells[x0i + 1] += d * xmf;
+            } else {
+                float s = 1 / (x1 - x0);
+                float x0f = x0 - x0floor;
+                float a0 = 0.5f * s * (1 - x0f) * (1 - x0f);
+                float x1f = x1 - x1ceil + 1;
+                float am = 0.5f * s * x1f * x1f;
+
+                cells[x0i] += d * a0;
+                if (x1i == x0i + 2) {
+                    cells[x0i + 1] += d * (1 - a0 - am);
+                } else {
+                    float a1 = s * (1.5f - x0f);
+                    cells[x0i + 1] += d * (a1 - a0);
+                    for (int xi = x0i + 2; xi < x1i - 1; xi++) {
+                        cells[xi] += d * s;
+                    }
+                    float a2 = a1 + (float(x1i - x0i - 3) * s);
+                    cells[x1i - 1] += d * (1 - a2 - am);
+                }
+                cells[x1i] += d * am;
+            }
+            x = xnext;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,7 @@
+#include <stdio.h>
+
+extern int main_tests(int argc, const char* argv[]);
+
+int main(int argc, const char* argv[]) {
+    return main_tests(argc, argv);
+}
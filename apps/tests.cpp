@@ -0,0 +1,63 @@
+#include "tests.h"
+#include <algorithm>
+#include <string>
+#include <string.h>
+
+static bool is_arg(const char arg[], const char name[]) {
+    std::string str("--");
+    str += name;
+    if (!strcmp(arg, str.c_str())) {
+        return true;
+    }
+
+    char shortVers[3];
+    shortVers[0] = '-';
+    shortVers[1] = name[0];
+    shortVers[2] = 0;
+    return !strcmp(arg, shortVers);
+}
+
+static int max_name_len() {
+    size_t len = 0;
+    for (int i = 0; gTestRecs[i].fTest; ++i) {
+        len = std::max(len, strlen(gTestRecs[i].fName));
+    }
+    return (int)len;
+}
+
+/*
+ *  Runs every test (or those whose name contains --match), printing the ones that fail (all of
+ *  them with --verbose). Returns nonzero if any failed.
+ */
+int main_tests(int argc, const char* argv[]) {
+    bool verbose = false;
+    const char* match = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (is_arg(argv[i], "verbose")) {
+            verbose = true;
+        } else if (is_arg(argv[i], "match") && i+1 < argc) {
+            match = argv[++i];
+        }
+    }
+
+    const int maxNameLen = max_name_len();
+
+    int passed = 0;
+    int count = 0;
+    for (int i = 0; gTestRecs[i].fTest; ++i) {
+        if (match && !strstr(gTestRecs[i].fName, match)) {
+            continue;
+        }
+
+        bool ok = gTestRecs[i].fTest();
+        if (verbose || !ok) {
+            printf("test: [%2d] %*s %s\n", i, maxNameLen, gTestRecs[i].fName, ok ? "ok" : "FAILED");
+        }
+        passed += ok;
+        count += 1;
+    }
+
+    printf("          passed: %d of %d\n", passed, count);
+    return (passed == count) ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#ifndef G_tests_DEFINED
+#define G_tests_DEFINED
+
+#include "../include/GBitmap.h"
+
+struct GTestRec {
+    bool        (*fTest)();
+    const char* fName;
+};
+
+/*
+ *  Array is terminated when fTest is NULL
+ */
+extern const GTestRec gTestRecs[];
+
+/*
+ *  Number of pixels that differ between two bitmaps of the same size.
+ */
+static inline int count_diffs(const GBitmap& a, const GBitmap& b) {
+    int diffs = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            diffs += *a.getAddr(x, y) != *b.getAddr(x, y);
+        }
+    }
+    return diffs;
+}
+
+#endif
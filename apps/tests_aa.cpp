@@ -0,0 +1,143 @@
+/**
+ *  Anti-aliased fills: coverage kernels (simd.h, blend.h)
+ */
+
+#include "tests.h"
+
+#include "../blend.h"
+#include "../simd.h"
+#include "../include/GCanvas.h"
+#include "../include/GRandom.h"
+#include "../include/GRect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+ *  accumulate_coverage rounds the same way in its vector body and its scalar tail: a row whose
+ *  running sum is one value everywhere gets that value's coverage in every pixel, halves
+ *  included.
+ */
+static bool test_accumulate_coverage() {
+    const int kCount = 11;   // two vectors of 4, and a tail of 3
+    float acc[kCount] = {};
+    uint8_t coverage[kCount];
+
+    for (int k = -520; k <= 520; ++k) {
+        // around each half step (k / 510), where the two roundings could disagree
+        float v = k / 510.0f;
+        for (float x : {std::nextafter(v, -2.0f), v, std::nextafter(v, 2.0f)}) {
+            // (the rest are zeros, so every running sum is exactly x)
+            acc[0] = x;
+            accumulate_coverage(acc, coverage, kCount);
+
+            float c = std::min(std::fabs(x), 1.0f);
+            uint8_t expected = uint8_t(c * 255 + 0.5f);
+            for (int i = 0; i < kCount; ++i) {
+                if (coverage[i] != expected) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// a premultiplied pixel: each color at most the alpha
+static GPixel random_pixel(GRandom& rand) {
+    unsigned a = rand.nextRange(0, 255);
+    return GPixel_PackARGB(a, rand.nextRange(0, a), rand.nextRange(0, a), rand.nextRange(0, a));
+}
+
+// runs of 0, 255 and partial coverage, long and short (see kCoverageRunMin)
+static std::vector<uint8_t> random_coverage(GRandom& rand, int count) {
+    std::vector<uint8_t> coverage;
+    while ((int)coverage.size() < count) {
+        int run = rand.nextRange(1, 3 * kCoverageRunMin);
+        int kind = rand.nextRange(0, 2);
+        for (int i = 0; i < run; ++i) {
+            uint8_t c = (kind == 0) ? 0 : (kind == 1) ? 255 : uint8_t(rand.nextRange(0, 255));
+            coverage.push_back(c);
+        }
+    }
+    coverage.resize(count);
+    return coverage;
+}
+
+/*
+ *  blend_coverage_row (runs, fused srcover, chunks and SSE) gives each pixel what blending it on
+ *  its own and lerping by its coverage does, in every blend mode, for a row or a single source.
+ */
+static bool test_blend_coverage_row() {
+    GRandom rand(7);
+    for (int mode = 0; mode <= (int)GBlendMode::kXor; ++mode) {
+        for (int trial = 0; trial < 40; ++trial) {
+            int count = rand.nextRange(0, 3 * kCoverageChunk);
+            std::vector<uint8_t> coverage = random_coverage(rand, count);
+            std::vector<GPixel> src(count + 1), dst(count);
+            for (GPixel& p : src) {
+                p = random_pixel(rand);
+            }
+            for (GPixel& p : dst) {
+                p = random_pixel(rand);
+            }
+
+            for (bool solid : {false, true}) {
+                std::vector<GPixel> result = dst;
+                if (solid) {
+                    blend_row(GBlendMode(mode), src[count], result.data(), coverage.data(), count);
+                } else {
+                    blend_row(GBlendMode(mode), src.data(), result.data(), coverage.data(), count);
+                }
+
+                for (int i = 0; i < count; ++i) {
+                    GPixel blended = dst[i];
+                    blend_row(GBlendMode(mode), &src[solid ? count : i], &blended, 1);
+                    if (result[i] != lerp_pixel(blended, dst[i], coverage[i])) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ *  Anti-aliased ovals, round rects and disc points draw the same pixels as the GCanvas
+ *  defaults, which fill them as paths.
+ */
+static bool test_aa_shapes() {
+    GBitmap a, b;
+    a.alloc(256, 200);
+    b.alloc(256, 200);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+
+    GRandom rand(11);
+    GPaint paint(GColor{0.9f, 0.3f, 0.1f, 0.6f});
+    paint.setAntiAlias(true);
+    GPaint disc = paint;
+    disc.setPointShape(GPointShape::kDisc);
+
+    ca->clear({1, 1, 1, 1});
+    cb->clear({1, 1, 1, 1});
+    for (int trial = 0; trial < 20; ++trial) {
+        GRect r = GRect::XYWH(rand.nextF() * 260 - 10, rand.nextF() * 210 - 10,
+                              1 + rand.nextF() * 80, 1 + rand.nextF() * 80);
+        ca->drawOval(r, paint);
+        cb->GCanvas::drawOval(r, paint);
+        ca->drawRRect(r.offset(5, 7), 9, 4, paint);
+        cb->GCanvas::drawRRect(r.offset(5, 7), 9, 4, paint);
+
+        GPoint pts[30];
+        for (GPoint& p : pts) {
+            p = {rand.nextF() * 256, rand.nextF() * 200};
+        }
+        float size = 1 + rand.nextF() * 11;
+        ca->drawPoints(pts, 30, size, disc);
+        cb->GCanvas::drawPoints(pts, 30, size, disc);
+    }
+    return count_diffs(a, b) == 0;
+}
@@ -0,0 +1,61 @@
+/**
+ *  Path blobs: PathBlob::Serialize and PathBlob::Make
+ */
+
+#include "tests.h"
+
+#include "../path_blob.h"
+#include "../include/GPathBuilder.h"
+#include "../include/GRect.h"
+
+#include <cstring>
+#include <limits>
+
+static bool same_rect(const GRect& a, const GRect& b) {
+    return (a.left == b.left) && (a.top == b.top) && (a.right == b.right) && (a.bottom == b.bottom);
+}
+
+/*
+ *  A blob's paths keep the stored bounds that hold them, and fall back to their own for
+ *  stored bounds that are too small or not finite.
+ */
+static bool test_blob_bounds() {
+    std::vector<std::shared_ptr<GPath>> paths;
+    for (int i = 0; i < 4; ++i) {
+        paths.push_back(GPathBuilder::Build([i](GPathBuilder& bu) {
+            bu.addCircle({50.0f + i, 40}, 30.5f);
+            bu.addRect(GRect::LTRB(5.5f, 5.25f, 40, 20 + i));
+        }));
+    }
+    std::vector<unsigned char> bytes = PathBlob::Serialize(paths);
+
+    // 0: as written, 1: padded, 2: too small, 3: infinite
+    const float inf = std::numeric_limits<float>::infinity();
+    const GRect own = paths[0]->bounds();
+    const GRect stored[] = {
+        paths[0]->bounds(),
+        GRect::LTRB(-10, -10, 200, 200),
+        GRect::LTRB(own.left + 1, own.top, own.right, own.bottom),
+        GRect::LTRB(-inf, -inf, inf, inf),
+    };
+    for (int i = 1; i < 4; ++i) {
+        PathBlobRecord r;
+        size_t at = sizeof(PathBlobHeader) + i * sizeof(PathBlobRecord);
+        memcpy(&r, bytes.data() + at, sizeof(r));
+        memcpy(r.bounds, &stored[i], sizeof(r.bounds));
+        memcpy(bytes.data() + at, &r, sizeof(r));
+    }
+
+    // (8-byte aligned, as a mapped file would be)
+    std::shared_ptr<uint64_t> data(new uint64_t[(bytes.size() + 7) / 8], std::default_delete<uint64_t[]>());
+    memcpy(data.get(), bytes.data(), bytes.size());
+    auto blob = PathBlob::Make(data, bytes.size());
+    if (!blob || (blob->count() != 4)) {
+        return false;
+    }
+
+    return same_rect(blob->path(0)->bounds(), paths[0]->bounds())
+        && same_rect(blob->path(1)->bounds(), stored[1])
+        && same_rect(blob->path(2)->bounds(), paths[2]->bounds())
+        && same_rect(blob->path(3)->bounds(), paths[3]->bounds());
+}
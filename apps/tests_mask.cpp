@@ -0,0 +1,173 @@
+/**
+ *  Alpha-only masks: GCreateMaskCanvas, GCanvas::drawMask and GCanvas::clipMask
+ */
+
+#include "tests.h"
+
+#include "../include/GCanvas.h"
+#include "../include/GMask.h"
+#include "../include/GPathBuilder.h"
+#include "../include/GRect.h"
+
+static std::shared_ptr<GPath> mask_shape() {
+    return GPathBuilder::Build([](GPathBuilder& bu) {
+        bu.addCircle({50, 40}, 30.3f);
+        bu.addRect(GRect::LTRB(5.5f, 5.25f, 40, 20));
+    });
+}
+
+// an anti-aliased circle and rect: a mask with partial coverage along its edges
+static GMask make_mask() {
+    GMask mask;
+    mask.alloc(100, 80);
+
+    GPaint paint;
+    paint.setAntiAlias(true);
+    GCreateMaskCanvas(mask)->drawPath(*mask_shape(), paint);
+    return mask;
+}
+
+static void draw_alpha_scene(GCanvas* canvas) {
+    canvas->clear({0, 0, 0, 0.25f});
+
+    GPaint aa;
+    aa.setAntiAlias(true);
+    canvas->drawPath(*mask_shape(), aa);
+
+    canvas->save();
+    canvas->translate(20, 30);
+    canvas->rotate(0.3f);
+    canvas->drawPath(*mask_shape(), GPaint(GColor{1, 0, 0, 0.5f}));
+    canvas->restore();
+
+    canvas->drawRect(GRect::LTRB(60, 5, 95, 75), GPaint(GColor{0, 1, 0, 0.6f}));
+    canvas->drawOval(GRect::LTRB(0, 50, 45, 80), GPaint().setBlendMode(GBlendMode::kXor));
+}
+
+/*
+ *  A mask canvas holds exactly the alpha an ARGB canvas gets from the same drawing.
+ */
+static bool test_mask_canvas_alpha() {
+    GMask mask;
+    mask.alloc(100, 80);
+    draw_alpha_scene(GCreateMaskCanvas(mask).get());
+
+    GBitmap bitmap;
+    bitmap.alloc(100, 80);
+    draw_alpha_scene(GCreateCanvas(bitmap).get());
+
+    for (int y = 0; y < mask.height(); ++y) {
+        for (int x = 0; x < mask.width(); ++x) {
+            if (*mask.getAddr(x, y) != GPixel_GetA(*bitmap.getAddr(x, y))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ *  Filling everything through clipMask draws the same pixels as drawMask, translated or not.
+ */
+static bool test_clip_mask_draw_mask() {
+    GMask mask = make_mask();
+    GPaint paint(GColor{1, 0, 0, 0.7f});
+
+    GBitmap a, b;
+    a.alloc(300, 200);
+    b.alloc(300, 200);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+
+    const GMatrix matrices[] = {
+        GMatrix(),
+        GMatrix::Scale(2.5f, 2) * GMatrix::Rotate(0.3f),
+    };
+    for (const GMatrix& m : matrices) {
+        ca->clear({0, 0.5f, 0, 1});
+        cb->clear({0, 0.5f, 0, 1});
+
+        ca->save();
+        ca->concat(m);
+        ca->drawMask(mask, 13, 27, paint);
+        ca->restore();
+
+        cb->save();
+        cb->concat(m);
+        cb->clipMask(mask, 13, 27);
+        cb->drawRect(GRect::LTRB(-100, -100, 400, 400), paint);
+        cb->restore();
+
+        if (count_diffs(a, b) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ *  restore() puts back the clip that was current at save(), nested or not.
+ */
+static bool test_clip_mask_restore() {
+    GMask mask = make_mask();
+    GPaint paint(GColor{0, 0, 1, 0.8f});
+    const GRect all = GRect::LTRB(0, 0, 300, 200);
+
+    GBitmap a, b;
+    a.alloc(300, 200);
+    b.alloc(300, 200);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+    ca->clear({1, 1, 1, 1});
+    cb->clear({1, 1, 1, 1});
+
+    // inner clip dropped: only the outer one
+    ca->drawMask(mask, 10, 10, paint);
+    cb->save();
+    cb->clipMask(mask, 10, 10);
+    cb->save();
+    cb->clipMask(mask, 150, 100);
+    cb->restore();
+    cb->drawRect(all, paint);
+
+    // both dropped: no clip at all
+    cb->restore();
+    ca->drawRect(GRect::LTRB(200, 0, 300, 50), paint);
+    cb->drawRect(GRect::LTRB(200, 0, 300, 50), paint);
+    return count_diffs(a, b) == 0;
+}
+
+/*
+ *  Nested clips intersect: each pixel gets the product of the masks' coverages.
+ */
+static bool test_clip_mask_intersect() {
+    GMask mask = make_mask();
+    GPaint paint(GColor{1, 0, 1, 1});
+
+    // the two masks' product, on the device
+    GMask product;
+    product.alloc(150, 80);
+    for (int y = 0; y < product.height(); ++y) {
+        for (int x = 0; x < product.width(); ++x) {
+            unsigned a = (x < 100) ? *mask.getAddr(x, y) : 0;
+            unsigned b = (x >= 30 && x < 130) ? *mask.getAddr(x - 30, y) : 0;
+            *product.getAddr(x, y) = (uint8_t)((a * b + 127) / 255);
+        }
+    }
+
+    GBitmap a, b;
+    a.alloc(200, 100);
+    b.alloc(200, 100);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+    ca->clear({0, 0, 0, 1});
+    cb->clear({0, 0, 0, 1});
+
+    ca->drawMask(product, 0, 0, paint);
+    cb->save();
+    cb->clipMask(mask, 0, 0);
+    cb->clipMask(mask, 30, 0);
+    cb->drawRect(GRect::LTRB(0, 0, 200, 100), paint);
+    cb->restore();
+    return count_diffs(a, b) == 0;
+}
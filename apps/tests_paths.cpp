@@ -0,0 +1,129 @@
+/**
+ *  Batched paths: GCanvas::drawPathInstances and GCanvas::drawPaths
+ */
+
+#include "tests.h"
+
+#include "../include/GCanvas.h"
+#include "../include/GPathBuilder.h"
+#include "../include/GRandom.h"
+
+#include <vector>
+
+// a convex path and one that isn't (two contours, with curves)
+static std::vector<std::shared_ptr<GPath>> instance_paths() {
+    return {
+        GPathBuilder::Build([](GPathBuilder& bu) {
+            bu.addCircle({0, 0}, 20.3f);
+        }),
+        GPathBuilder::Build([](GPathBuilder& bu) {
+            bu.addRect(GRect::LTRB(-25.5f, -10.25f, 30, 12));
+            bu.moveTo({-20, 25});
+            bu.quadTo({0, -40}, {22, 24});
+            bu.cubicTo({10, 0}, {-5, 50}, {-20, 25});
+        }),
+    };
+}
+
+// instances at a few scales/skews, inside the device, across its edges and off it
+static std::vector<GMatrix> instance_matrices(GRandom& rand, int width, int height) {
+    const GMatrix linears[] = {
+        GMatrix(),
+        GMatrix::Scale(1.7f, 0.6f),
+        GMatrix::Rotate(0.5f) * GMatrix::Scale(0.8f, 1.3f),
+    };
+    std::vector<GMatrix> matrices;
+    for (const GMatrix& linear : linears) {
+        for (int i = 0; i < 40; ++i) {
+            float x = rand.nextF() * (width + 120) - 60;
+            float y = rand.nextF() * (height + 120) - 60;
+            matrices.push_back(GMatrix::Translate(x, y) * linear);
+        }
+    }
+    return matrices;
+}
+
+/*
+ *  drawPathInstances draws the same pixels as drawing each instance on its own, whether the
+ *  instance is placed from the edge template (inside the device) or clipped (on its edges).
+ */
+static bool test_path_instances() {
+    GBitmap a, b;
+    a.alloc(256, 200);
+    b.alloc(256, 200);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+
+    GRandom rand(5);
+    GPaint paint(GColor{0.2f, 0.6f, 1, 0.5f});
+    for (const auto& path : instance_paths()) {
+        auto matrices = instance_matrices(rand, a.width(), a.height());
+        ca->clear({1, 1, 1, 1});
+        cb->clear({1, 1, 1, 1});
+
+        ca->save();
+        ca->translate(3.25f, -2.5f);
+        ca->drawPathInstances(*path, matrices.data(), (int)matrices.size(), paint);
+        ca->restore();
+
+        cb->save();
+        cb->translate(3.25f, -2.5f);
+        cb->GCanvas::drawPathInstances(*path, matrices.data(), (int)matrices.size(), paint);
+        cb->restore();
+
+        if (count_diffs(a, b) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ *  Anti-aliased, drawPaths and drawPathInstances draw the same pixels as drawing each path (or
+ *  instance) on its own, overlaps included.
+ */
+static bool test_aa_path_batches() {
+    GBitmap a, b;
+    a.alloc(256, 200);
+    b.alloc(256, 200);
+    auto ca = GCreateCanvas(a);
+    auto cb = GCreateCanvas(b);
+
+    GRandom rand(9);
+    GPaint paint(GColor{0.2f, 0.6f, 1, 0.5f});
+    paint.setAntiAlias(true);
+
+    for (int trial = 0; trial < 10; ++trial) {
+        std::vector<std::shared_ptr<GPath>> paths;
+        std::vector<const GPath*> ptrs;
+        for (int i = 0; i < 8; ++i) {
+            auto rnd = [&rand](float lo, float hi) { return lo + rand.nextF() * (hi - lo); };
+            paths.push_back(GPathBuilder::Build([&rnd](GPathBuilder& bu) {
+                bu.addCircle({rnd(-20, 276), rnd(-20, 220)}, rnd(0.5f, 60));
+                bu.moveTo({rnd(0, 256), rnd(0, 200)});
+                bu.lineTo({rnd(0, 256), rnd(0, 200)});
+                bu.quadTo({rnd(0, 256), rnd(0, 200)}, {rnd(0, 256), rnd(0, 200)});
+            }));
+            ptrs.push_back(paths.back().get());
+        }
+        ptrs.push_back(nullptr);
+
+        ca->clear({1, 1, 1, 1});
+        cb->clear({1, 1, 1, 1});
+        ca->drawPaths(ptrs.data(), (int)ptrs.size(), paint);
+        cb->GCanvas::drawPaths(ptrs.data(), (int)ptrs.size(), paint);
+        if (count_diffs(a, b) != 0) {
+            return false;
+        }
+
+        auto matrices = instance_matrices(rand, a.width(), a.height());
+        for (const auto& path : instance_paths()) {
+            ca->drawPathInstances(*path, matrices.data(), (int)matrices.size(), paint);
+            cb->GCanvas::drawPathInstances(*path, matrices.data(), (int)matrices.size(), paint);
+        }
+        if (count_diffs(a, b) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
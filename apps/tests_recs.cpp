@@ -0,0 +1,25 @@
+#include "tests_mask.cpp"
+#include "tests_tiled.cpp"
+#include "tests_blob.cpp"
+#include "tests_stroke.cpp"
+#include "tests_paths.cpp"
+#include "tests_aa.cpp"
+
+const GTestRec gTestRecs[] = {
+    { test_mask_canvas_alpha,    "mask_canvas_alpha" },
+    { test_clip_mask_draw_mask,  "clip_mask_draw_mask" },
+    { test_clip_mask_restore,    "clip_mask_restore" },
+    { test_clip_mask_intersect,  "clip_mask_intersect" },
+    { test_tiled_matches_bitmap, "tiled_matches_bitmap" },
+    { test_tiled_sparse,         "tiled_sparse" },
+    { test_tiled_clear,          "tiled_clear" },
+    { test_blob_bounds,          "blob_bounds" },
+    { test_stroke_polyline,      "stroke_polyline" },
+    { test_path_instances,       "path_instances" },
+    { test_aa_path_batches,      "aa_path_batches" },
+    { test_accumulate_coverage,  "accumulate_coverage" },
+    { test_blend_coverage_row,   "blend_coverage_row" },
+    { test_aa_shapes,            "aa_shapes" },
+
+    { nullptr, nullptr },
+};
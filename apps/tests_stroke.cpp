@@ -0,0 +1,124 @@
+/**
+ *  Strokes: GFinal::strokePolygon (stroke_polyline)
+ */
+
+#include "tests.h"
+
+#include "../include/GCanvas.h"
+#include "../include/GFinal.h"
+#include "../include/GRandom.h"
+#include "../include/GRect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// distance from (p) to the segment a..b (the reference: independent of edge.h)
+static float distance_to_segment(GPoint p, GPoint a, GPoint b) {
+    GVector d = b - a;
+    float len2 = (d.x * d.x) + (d.y * d.y);
+    float t = (len2 > 0) ? (((p.x - a.x) * d.x) + ((p.y - a.y) * d.y)) / len2 : 0;
+    t = std::max(0.0f, std::min(1.0f, t));
+    return (p - (a + d * t)).length();
+}
+
+/*
+ *  The pixels of the stroke of pts[] whose centers are wrongly in or out of it: farther from
+ *  the outline than (slop) and on the other side of it from where the distance to the polyline
+ *  puts them.
+ */
+static int count_stroke_errors(GFinal* fin, const std::vector<GPoint>& pts, float width,
+                               bool closed, float slop) {
+    GBitmap bitmap;
+    bitmap.alloc(256, 256);
+    auto canvas = GCreateCanvas(bitmap);
+    canvas->clear({0, 0, 0, 0});
+    auto path = fin->strokePolygon(pts.data(), (int)pts.size(), width, closed);
+    canvas->drawPath(*path, GPaint(GColor{1, 1, 1, 1}));
+
+    // beyond this box around the points, nothing should be drawn
+    float margin = width / 2 + slop;
+    GRect box = GRect::LTRB(pts[0].x, pts[0].y, pts[0].x, pts[0].y);
+    for (GPoint p : pts) {
+        box = GRect::LTRB(std::min(box.left, p.x - margin), std::min(box.top, p.y - margin),
+                          std::max(box.right, p.x + margin), std::max(box.bottom, p.y + margin));
+    }
+
+    int errors = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            GPoint p = {x + 0.5f, y + 0.5f};
+            bool drawn = GPixel_GetA(*bitmap.getAddr(x, y)) != 0;
+            if ((p.x < box.left) || (p.x > box.right) || (p.y < box.top) || (p.y > box.bottom)) {
+                errors += drawn;
+                continue;
+            }
+
+            float d = (p - pts[0]).length();
+            for (size_t i = 0; i + 1 < pts.size(); ++i) {
+                d = std::min(d, distance_to_segment(p, pts[i], pts[i + 1]));
+            }
+            if (closed) {
+                d = std::min(d, distance_to_segment(p, pts.back(), pts[0]));
+            }
+
+            bool inside = d <= width / 2;
+            errors += (inside != drawn) && (std::fabs(d - width / 2) > slop);
+        }
+    }
+    return errors;
+}
+
+/*
+ *  A stroke covers the pixels within half its width of the polyline, give or take the pixels
+ *  right along its outline: random polylines (open or closed, with repeated points, tiny
+ *  segments and reversals), and the cases that take stroke_join's special branches.
+ */
+static bool test_stroke_polyline() {
+    const float kSlop = 0.75f;
+    auto fin = GCreateFinal();
+
+    struct Case {
+        std::vector<GPoint> pts;
+        float width;
+        bool closed;
+    };
+    const Case cases[] = {
+        {{{60, 80}, {190, 150}}, 30, true},                              // closed, 2 points
+        {{{60, 80}, {190, 150}, {60, 80}}, 20, false},                   // reversal
+        {{{60, 80}, {190, 150}, {60, 80}}, 20, true},
+        {{{40, 40}, {200, 200}, {120, 120}, {220, 40}}, 12, false},      // partial reversal
+        {{{50, 60}, {50, 60}, {180, 70}, {180, 70}, {180, 70}, {90, 200}}, 25, false},  // repeats
+        {{{50, 60}, {180, 70}, {90, 200}, {50, 60}}, 25, true},          // closed on its start
+        {{{128, 128}, {128, 128}}, 40, true},                            // a dot
+        {{{40, 128}, {128, 128}, {216, 128.00001f}}, 30, false},         // (nearly) straight
+    };
+    for (const Case& c : cases) {
+        if (count_stroke_errors(fin.get(), c.pts, c.width, c.closed, kSlop) != 0) {
+            return false;
+        }
+    }
+
+    GRandom rand(3);
+    for (int trial = 0; trial < 300; ++trial) {
+        std::vector<GPoint> pts;
+        int n = rand.nextRange(2, 11);
+        for (int i = 0; i < n; ++i) {
+            if ((i > 0) && (rand.nextRange(0, 5) == 0)) {
+                // back to an earlier point
+                pts.push_back(pts[rand.nextRange(0, i - 1)]);
+            } else if ((i > 0) && (rand.nextRange(0, 4) == 0)) {
+                // a tiny segment
+                pts.push_back(pts.back() + GVector{rand.nextF() * 4 - 2, rand.nextF() * 4 - 2});
+            } else {
+                pts.push_back({40 + rand.nextF() * 176, 40 + rand.nextF() * 176});
+            }
+        }
+        bool closed = rand.nextRange(0, 1);
+        float width = 1 + rand.nextF() * 59;
+        if (count_stroke_errors(fin.get(), pts, width, closed, kSlop) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+/**
+ *  Sparse tiled canvases: GTiledBitmap and GCreateTiledCanvas
+ */
+
+#include "tests.h"
+
+#include "../include/GCanvas.h"
+#include "../include/GMask.h"
+#include "../include/GPathBuilder.h"
+#include "../include/GRandom.h"
+#include "../include/GRect.h"
+#include "../include/GShader.h"
+#include "../include/GTiledBitmap.h"
+
+#include <vector>
+
+// the pixels of a tiled bitmap that differ from a plain one of the same size
+static int count_tiled_diffs(const GTiledBitmap& tiled, const GBitmap& bitmap) {
+    int diffs = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            diffs += tiled.getPixel(x, y) != *bitmap.getAddr(x, y);
+        }
+    }
+    return diffs;
+}
+
+// a bit of everything, crossing tile boundaries (GTiledBitmap::kTileSize)
+static void draw_tiled_scene(GCanvas* canvas, const GMask& mask) {
+    auto path = GPathBuilder::Build([](GPathBuilder& bu) {
+        bu.addCircle({300, 250}, 180.3f);
+        bu.addRect(GRect::LTRB(5.5f, 5.25f, 600, 40));
+    });
+    GPaint paint(GColor{0.2f, 0.3f, 0.9f, 0.8f});
+    canvas->drawPath(*path, paint);
+
+    paint.setAntiAlias(true);
+    canvas->save();
+    canvas->translate(400, 100);
+    canvas->rotate(0.4f);
+    canvas->drawPath(*path, paint);
+    canvas->restore();
+
+    auto sh = GCreateLinearGradient({0, 0}, {900, 600}, {1, 0, 0, 1}, {0, 1, 0, 0.5f},
+                                    GTileMode::kMirror);
+    canvas->drawRect(GRect::LTRB(250, 300, 990, 690), GPaint(sh));
+
+    const GPoint quad[4] = {{10, 400}, {200, 380}, {240, 690}, {0, 650}};
+    const GColor colors[4] = {{1, 0, 0, 1}, {0, 1, 0, 1}, {0, 0, 1, 1}, {1, 1, 0, 0.5f}};
+    canvas->drawQuad(quad, colors, nullptr, 5, GPaint());
+
+    // enough triangles to be binned into tiles
+    GRandom rand;
+    std::vector<GPoint> verts;
+    std::vector<GColor> vertColors;
+    std::vector<int> indices;
+    for (int i = 0; i < 3 * 300; ++i) {
+        GPoint p = {rand.nextF() * 1000, rand.nextF() * 700};
+        if (i % 3) {
+            p = verts[i - 1] + GVector{rand.nextF() * 60 - 30, rand.nextF() * 60 - 30};
+        }
+        verts.push_back(p);
+        vertColors.push_back({rand.nextF(), rand.nextF(), rand.nextF(), 0.5f});
+        indices.push_back(i);
+    }
+    canvas->drawMesh(verts.data(), vertColors.data(), nullptr, 300, indices.data(), GPaint());
+
+    const GPoint pts[5] = {{0, 0}, {999, 699}, {500, 10}, {0, 699}, {999, 0}};
+    canvas->drawPolyline(pts, 5, GPaint(GColor{0, 0, 0, 1}));
+
+    canvas->drawMask(mask, 700, 20, GPaint(GColor{1, 0, 1, 1}));
+    canvas->save();
+    canvas->clipMask(mask, 650, 200);
+    canvas->drawRect(GRect::LTRB(0, 0, 1000, 700), GPaint(GColor{0, 1, 1, 0.7f}));
+    canvas->restore();
+
+    // a column on either side of a tile boundary
+    canvas->drawRect(GRect::LTRB(255, 0, 257, 700), GPaint(GColor{0, 0, 0, 0.5f}));
+}
+
+/*
+ *  A tiled canvas draws the same pixels as a plain one, tile boundaries included.
+ */
+static bool test_tiled_matches_bitmap() {
+    GMask mask;
+    mask.alloc(120, 90);
+    GPaint aa;
+    aa.setAntiAlias(true);
+    auto circle = GPathBuilder::Build([](GPathBuilder& bu) {
+        bu.addCircle({60, 45}, 40);
+    });
+    GCreateMaskCanvas(mask)->drawPath(*circle, aa);
+
+    GBitmap bitmap;
+    bitmap.alloc(1000, 700);
+    auto plain = GCreateCanvas(bitmap);
+    plain->clear({1, 1, 1, 1});
+    draw_tiled_scene(plain.get(), mask);
+
+    GTiledBitmap tiled(1000, 700);
+    auto canvas = GCreateTiledCanvas(tiled);
+    canvas->clear({1, 1, 1, 1});
+    draw_tiled_scene(canvas.get(), mask);
+
+    return count_tiled_diffs(tiled, bitmap) == 0;
+}
+
+/*
+ *  Only the tiles drawn into are allocated; the rest read as the background.
+ */
+static bool test_tiled_sparse() {
+    const int T = GTiledBitmap::kTileSize;
+    const GPixel background = GPixel_PackARGB(0xFF, 0xFF, 0, 0);
+    GTiledBitmap tiled(100000, 100000, background);
+    auto canvas = GCreateTiledCanvas(tiled);
+
+    // inside one tile, then across the corner of four
+    GPaint paint(GColor{0, 0, 1, 1});
+    canvas->drawRect(GRect::LTRB(10, 10, 20, 20), paint);
+    canvas->drawRect(GRect::XYWH(5 * T - 4, 7 * T - 4, 8, 8), paint);
+    if (tiled.tileCount() != 5) {
+        return false;
+    }
+
+    const GPixel blue = GPixel_PackARGB(0xFF, 0, 0, 0xFF);
+    return (tiled.getPixel(15, 15) == blue) && (tiled.getPixel(20, 20) == background)
+        && (tiled.getPixel(5 * T - 4, 7 * T - 4) == blue) && (tiled.getPixel(5 * T + 3, 7 * T + 3) == blue)
+        && (tiled.getPixel(5 * T + 4, 7 * T) == background) && (tiled.peekTile(3, 3) == nullptr);
+}
+
+/*
+ *  clear() frees every tile when nothing clips it, and only paints the clip when something does.
+ */
+static bool test_tiled_clear() {
+    GTiledBitmap huge(100000, 100000);
+    auto canvas = GCreateTiledCanvas(huge);
+
+    GPaint paint(GColor{1, 0, 0, 1});
+    canvas->drawRect(GRect::LTRB(1000, 1000, 1300, 1300), paint);
+    canvas->drawLine({0, 0}, {99999, 99999}, paint);
+    canvas->clear({0, 0, 0, 1});
+    if ((huge.tileCount() != 0) || (huge.getPixel(99999, 5) != GPixel_PackARGB(0xFF, 0, 0, 0))) {
+        return false;
+    }
+
+    // clipped: the same as a plain canvas
+    GMask mask;
+    mask.alloc(100, 100);
+    GCreateMaskCanvas(mask)->drawOval(GRect::LTRB(0, 0, 100, 100), GPaint());
+
+    GBitmap bitmap;
+    bitmap.alloc(600, 400);
+    GTiledBitmap tiled(600, 400);
+    auto plain = GCreateCanvas(bitmap);
+    auto tiledCanvas = GCreateTiledCanvas(tiled);
+    for (GCanvas* c : {plain.get(), tiledCanvas.get()}) {
+        c->clear({1, 1, 1, 1});
+        c->save();
+        c->clipMask(mask, 220, 200);
+        c->clear({0, 1, 0, 0.5f});
+        c->restore();
+    }
+    // (the clip's box touches the four tiles at the top left)
+    return (count_tiled_diffs(tiled, bitmap) == 0) && (tiled.tileCount() == 4);
+}
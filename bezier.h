@@ -63,7 +63,7 @@ inline GRect quadBounds(GPoint pts[GPath::kMaxNextPoints]) {
     xVals.push_back(pts[2].x);
 
     yVals.push_back(pts[0].y);
-    yVals.push_back(pts[0].y);
+    yVals.push_back(pts[2].y);
 
     GPoint src[3] = {pts[0], pts[1], pts[2]};
 
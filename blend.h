@@ -5,7 +5,11 @@
 #include "include/GPaint.h"
 #include "include/GPixel.h"
 #include "include/GShader.h"
+#include "simd.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 /* div255()
@@ -16,6 +20,18 @@ inline unsigned div255(unsigned x) {
     return (x * K + (1 << 23)) >> 24;
 }
 
+/* lerp_pixel()
+ * (src) where (coverage) is 255, (dst) where it is 0, and in between for partial coverage
+ */
+inline GPixel lerp_pixel(GPixel src, GPixel dst, unsigned coverage) {
+    unsigned inv = 255 - coverage;
+    unsigned a = div255((GPixel_GetA(src) * coverage) + (GPixel_GetA(dst) * inv));
+    unsigned r = div255((GPixel_GetR(src) * coverage) + (GPixel_GetR(dst) * inv));
+    unsigned g = div255((GPixel_GetG(src) * coverage) + (GPixel_GetG(dst) * inv));
+    unsigned b = div255((GPixel_GetB(src) * coverage) + (GPixel_GetB(dst) * inv));
+    return GPixel_PackARGB(a, r, g, b);
+}
+
 /* convertColor2Pixel()
  * converts GColor (color) to GPixel (pixel)
  */
@@ -456,6 +472,382 @@ inline GPixel blend_kXor(GPixel* src, GPixel* dst) {
     return GPixel_PackARGB(a,r,g,b);
 }
 
+/* ROW FUNCTIONS */
+
+/* blend_row_proc()
+ * applies a single blend function (blend) to every pixel of a row
+ */
+template <GPixel (*blend)(GPixel*, GPixel*)>
+inline void blend_row_proc(const GPixel src[], GPixel dst[], int count) {
+    for (int i = 0; i < count; i++) {
+        GPixel s = src[i];
+        dst[i] = blend(&s, &dst[i]);
+    }
+}
+
+template <GPixel (*blend)(GPixel*, GPixel*)>
+inline void blend_row_proc(GPixel src, GPixel dst[], int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = blend(&src, &dst[i]);
+    }
+}
+
+/* blend_row()
+ * blends a row of premultiplied source pixels (src) into a row of the device (dst)
+ * the switch on the blend mode happens once per row instead of once per pixel
+ */
+inline void blend_row(GBlendMode mode, const GPixel src[], GPixel dst[], int count) {
+    switch (mode) {
+        case GBlendMode::kClear:
+            std::fill(dst, dst + count, GPixel_PackARGB(0,0,0,0));
+            break;
+
+        case GBlendMode::kSrc:
+            std::copy(src, src + count, dst);
+            break;
+
+        case GBlendMode::kDst:
+            break;
+
+        case GBlendMode::kSrcOver:
+            blend_row_proc<blend_kSrcOver>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstOver:
+            blend_row_proc<blend_kDstOver>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcIn:
+            blend_row_proc<blend_kSrcIn>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstIn:
+            blend_row_proc<blend_kDstIn>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcOut:
+            blend_row_proc<blend_kSrcOut>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstOut:
+            blend_row_proc<blend_kDstOut>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcATop:
+            blend_row_proc<blend_kSrcATop>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstATop:
+            blend_row_proc<blend_kDstATop>(src, dst, count);
+            break;
+
+        case GBlendMode::kXor:
+            blend_row_proc<blend_kXor>(src, dst, count);
+            break;
+    }
+}
+
+/* blend_row()
+ * same as above, for a single (constant) source pixel
+ */
+inline void blend_row(GBlendMode mode, GPixel src, GPixel dst[], int count) {
+    switch (mode) {
+        case GBlendMode::kClear:
+            std::fill(dst, dst + count, GPixel_PackARGB(0,0,0,0));
+            break;
+
+        case GBlendMode::kSrc:
+            std::fill(dst, dst + count, src);
+            break;
+
+        case GBlendMode::kDst:
+            break;
+
+        case GBlendMode::kSrcOver:
+            blend_row_proc<blend_kSrcOver>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstOver:
+            blend_row_proc<blend_kDstOver>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcIn:
+            blend_row_proc<blend_kSrcIn>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstIn:
+            blend_row_proc<blend_kDstIn>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcOut:
+            blend_row_proc<blend_kSrcOut>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstOut:
+            blend_row_proc<blend_kDstOut>(src, dst, count);
+            break;
+
+        case GBlendMode::kSrcATop:
+            blend_row_proc<blend_kSrcATop>(src, dst, count);
+            break;
+
+        case GBlendMode::kDstATop:
+            blend_row_proc<blend_kDstATop>(src, dst, count);
+            break;
+
+        case GBlendMode::kXor:
+            blend_row_proc<blend_kXor>(src, dst, count);
+            break;
+    }
+}
+
+/* COVERAGE ROW FUNCTIONS */
+/* Partially covered pixels (anti-aliasing, masks) blend as lerp(dst, blend(src, dst), coverage),
+ * coverage being 0..255. Runs of coverage 0 are left alone and runs of 255 blend as plain rows
+ * (see blend_row()); the rest are blended into a scratch row, then lerped into the device. The
+ * lerp (and src-over, fused with it) runs 4 pixels at a time with SSE2, its div255 rounding the
+ * same as the scalar one's: ((x + 128) + ((x + 128) >> 8)) >> 8.
+ */
+
+// pixels blended at a time into the scratch row of a partially covered run
+constexpr int kCoverageChunk = 64;
+
+// runs of coverage 0 or 255 shorter than this are blended as partial coverage
+constexpr int kCoverageRunMin = 8;
+
+#if defined(__SSE2__)
+/* div255_epi16()
+ * div255() of each 16 bit lane, for lanes up to 255 * 255
+ */
+inline __m128i div255_epi16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/* coverage_epi16()
+ * the coverage of 4 pixels, each repeated in the 4 lanes of its pixel's channels: pixels 0-1 in
+ * (*lo), pixels 2-3 in (*hi)
+ */
+inline void coverage_epi16(const uint8_t coverage[], __m128i* lo, __m128i* hi) {
+    int32_t packed;
+    std::memcpy(&packed, coverage, 4);
+    __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), _mm_setzero_si128());
+    c = _mm_unpacklo_epi16(c, c);
+    *lo = _mm_unpacklo_epi32(c, c);
+    *hi = _mm_unpackhi_epi32(c, c);
+}
+
+/* lerp_epi16()
+ * lerp_pixel() of the 2 pixels in each of (src, dst, coverage), as 16 bit lanes
+ */
+inline __m128i lerp_epi16(__m128i src, __m128i dst, __m128i coverage) {
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), coverage);
+    return div255_epi16(_mm_add_epi16(_mm_mullo_epi16(src, coverage), _mm_mullo_epi16(dst, inv)));
+}
+
+/* srcover_epi16()
+ * blend_kSrcOver() of the 2 pixels in each of (src, dst), as 16 bit lanes
+ */
+inline __m128i srcover_epi16(__m128i src, __m128i dst) {
+    __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), sa);
+    return _mm_add_epi16(src, div255_epi16(_mm_mullo_epi16(dst, inv)));
+}
+#endif
+
+/* lerp_row()
+ * dst[i] = lerp_pixel(result[i], dst[i], coverage[i])
+ */
+inline void lerp_row(const GPixel result[], GPixel dst[], const uint8_t coverage[], int count) {
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i r = _mm_loadu_si128((const __m128i*)(result + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i clo, chi;
+        coverage_epi16(coverage + i, &clo, &chi);
+
+        __m128i lo = lerp_epi16(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(d, zero), clo);
+        __m128i hi = lerp_epi16(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(d, zero), chi);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = lerp_pixel(result[i], dst[i], coverage[i]);
+    }
+}
+
+/* srcover_lerp_row()
+ * blend_kSrcOver() with coverage, fused: src is (src) if (solid), else src[i]
+ */
+template <bool solid>
+inline void srcover_lerp_row(const GPixel src[], GPixel dst[], const uint8_t coverage[], int count) {
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i solidLo = _mm_unpacklo_epi8(_mm_set1_epi32(int32_t(src[0])), zero);
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i dlo = _mm_unpacklo_epi8(d, zero);
+        __m128i dhi = _mm_unpackhi_epi8(d, zero);
+        __m128i slo = solidLo;
+        __m128i shi = solidLo;
+        if (!solid) {
+            __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+            slo = _mm_unpacklo_epi8(s, zero);
+            shi = _mm_unpackhi_epi8(s, zero);
+        }
+        __m128i clo, chi;
+        coverage_epi16(coverage + i, &clo, &chi);
+
+        __m128i lo = lerp_epi16(srcover_epi16(slo, dlo), dlo, clo);
+        __m128i hi = lerp_epi16(srcover_epi16(shi, dhi), dhi, chi);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < count; i++) {
+        GPixel s = src[solid ? 0 : i];
+        dst[i] = lerp_pixel(blend_kSrcOver(&s, &dst[i]), dst[i], coverage[i]);
+    }
+}
+
+/* coverage_run()
+ * the end of the run of coverage equal to (value) from (i), checked 8 at a time
+ */
+inline int coverage_run(const uint8_t coverage[], int i, int count, uint8_t value) {
+    const uint64_t pattern = 0x0101010101010101ull * value;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t bytes;
+        std::memcpy(&bytes, coverage + i, 8);
+        if (bytes != pattern) {
+            break;
+        }
+    }
+    while ((i < count) && (coverage[i] == value)) {
+        i++;
+    }
+    return i;
+}
+
+/* partial_run()
+ * the end of the run of partial coverage from (i): up to the next run of 0 or 255 that's at
+ * least kCoverageRunMin long
+ */
+inline int partial_run(const uint8_t coverage[], int i, int count) {
+    while (i < count) {
+        uint8_t c = coverage[i];
+        if ((c == 0) || (c == 255)) {
+            int end = coverage_run(coverage, i, std::min(i + kCoverageRunMin, count), c);
+            if ((end - i == kCoverageRunMin) || (end == count)) {
+                break;
+            }
+            i = end;
+        } else {
+            i++;
+        }
+    }
+    return i;
+}
+
+/* blend_partial_row()
+ * blend (src) (src[0] if (solid)) into (dst) with coverage, through a scratch row
+ */
+template <bool solid>
+inline void blend_partial_row(GBlendMode mode, const GPixel src[], GPixel dst[], const uint8_t coverage[], int count) {
+    if (mode == GBlendMode::kSrcOver) {
+        srcover_lerp_row<solid>(src, dst, coverage, count);
+        return;
+    }
+
+    GPixel blended[kCoverageChunk];
+    for (int i = 0; i < count; i += kCoverageChunk) {
+        int n = std::min(kCoverageChunk, count - i);
+        std::copy(dst + i, dst + i + n, blended);
+        if (solid) {
+            blend_row(mode, src[0], blended, n);
+        } else {
+            blend_row(mode, src + i, blended, n);
+        }
+        lerp_row(blended, dst + i, coverage + i, n);
+    }
+}
+
+/* blend_coverage_row()
+ * blend (src) (src[0] if (solid)) into (dst), pixel i covered by coverage[i]
+ */
+template <bool solid>
+inline void blend_coverage_row(GBlendMode mode, const GPixel src[], GPixel dst[], const uint8_t coverage[], int count) {
+    if (mode == GBlendMode::kDst) {
+        return;
+    }
+
+    int i = 0;
+    while (i < count) {
+        uint8_t c = coverage[i];
+        int end = ((c == 0) || (c == 255)) ? coverage_run(coverage, i, count, c) : i;
+        if ((end - i < kCoverageRunMin) && (end < count)) {
+            end = partial_run(coverage, i, count);
+            c = 1;
+        }
+
+        const GPixel* s = solid ? src : src + i;
+        if (c == 255) {
+            if (solid) {
+                blend_row(mode, src[0], dst + i, end - i);
+            } else {
+                blend_row(mode, s, dst + i, end - i);
+            }
+        } else if (c != 0) {
+            blend_partial_row<solid>(mode, s, dst + i, coverage + i, end - i);
+        }
+        i = end;
+    }
+}
+
+/* blend_row()
+ * blends a row of source pixels (src), or a single one, into the device (dst), pixel i covered
+ * by coverage[i]
+ */
+inline void blend_row(GBlendMode mode, const GPixel src[], GPixel dst[], const uint8_t coverage[], int count) {
+    blend_coverage_row<false>(mode, src, dst, coverage, count);
+}
+
+inline void blend_row(GBlendMode mode, GPixel src, GPixel dst[], const uint8_t coverage[], int count) {
+    blend_coverage_row<true>(mode, &src, dst, coverage, count);
+}
+
+/* blend_row()
+ * same as above, with every pixel covered by (coverage)
+ */
+inline void blend_row(GBlendMode mode, const GPixel src[], GPixel dst[], unsigned coverage, int count) {
+    if (coverage >= 255) {
+        blend_row(mode, src, dst, count);
+    } else if (coverage > 0) {
+        uint8_t constant[kCoverageChunk];
+        std::fill(constant, constant + kCoverageChunk, uint8_t(coverage));
+        for (int i = 0; i < count; i += kCoverageChunk) {
+            blend_partial_row<false>(mode, src + i, dst + i, constant, std::min(kCoverageChunk, count - i));
+        }
+    }
+}
+
+inline void blend_row(GBlendMode mode, GPixel src, GPixel dst[], unsigned coverage, int count) {
+    if (coverage >= 255) {
+        blend_row(mode, src, dst, count);
+    } else if (coverage > 0) {
+        uint8_t constant[kCoverageChunk];
+        std::fill(constant, constant + kCoverageChunk, uint8_t(coverage));
+        for (int i = 0; i < count; i += kCoverageChunk) {
+            blend_partial_row<true>(mode, &src, dst + i, constant, std::min(kCoverageChunk, count - i));
+        }
+    }
+}
+
 /* GET BLEND */
 
 /* blend() 
@@ -508,7 +900,8 @@ inline GPixel blendPaint(const GPaint src, GPixel* dst) {
 }
 
 /* get_optimized_blend()
- * get new GBlendMode based on src.getAlpha()
+ * get new GBlendMode based on src.getAlpha() (or, with a shader, whether it's opaque: the
+ * alpha of a shader that isn't varies, so its mode can't be reduced)
  */
 inline GBlendMode get_optimized_blend(const GPaint& src) {
     float alpha = src.getAlpha();
@@ -518,7 +911,7 @@ inline GBlendMode get_optimized_blend(const GPaint& src) {
         if ((*shader).isOpaque()){
             alpha = 1;
         } else {
-            alpha = 0;
+            return src.getBlendMode();
         }
     }
 
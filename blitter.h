@@ -0,0 +1,257 @@
+#ifndef BLITTER_DEFINED
+#define BLITTER_DEFINED
+
+#include "blend.h"
+#include "include/GBitmap.h"
+#include "include/GMask.h"
+#include "include/GTiledBitmap.h"
+#include "include/GPaint.h"
+#include "include/GPixel.h"
+#include "include/GShader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/* Blitter
+ * writes horizontal runs of pixels into the device using the paint's color (or shader)
+ * and blend mode. The shader's context must already be set by the caller.
+ *
+ * The device may instead be alpha-only (setAlphaDevice()): only the alpha of the color (or
+ * shader) is blended into it; or tiled (setTiledDevice()): runs are split at tiles, which are
+ * allocated as they're written. With a clip (setClip()), each pixel is also covered by the
+ * clip's coverage of it, and pixels outside the clip's box aren't at all.
+ */
+class Blitter {
+public:
+    /* constructor */
+    Blitter(const GBitmap& device, const GPaint& paint) :
+            fDevice(device), fShader(paint.peekShader()), fMode(paint.getBlendMode()) {
+        fColor = convertColor2Pixel(paint.getColor());
+    }
+
+    /* setShader()
+     * swap the shader used for subsequent rows (e.g. one shader per mesh triangle)
+     */
+    void setShader(GShader* shader) {
+        fShader = shader;
+    }
+
+    /* setAlphaDevice()
+     * write into (alpha), the same size as the device, instead
+     */
+    void setAlphaDevice(const GMask* alpha) {
+        fAlphaDevice = alpha;
+    }
+
+    /* setTiledDevice()
+     * write into (tiles), the same size as the device, instead
+     */
+    void setTiledDevice(GTiledBitmap* tiles) {
+        fTiledDevice = tiles;
+    }
+
+    /* setClip()
+     * cover pixels by (clip), its top left at (left, top) on the device (none if null)
+     */
+    void setClip(const GMask* clip, int left, int top) {
+        fClip = clip;
+        fClipLeft = left;
+        fClipTop = top;
+    }
+
+    /* blitRow()
+     * fill pixels [x, x + count) on row y
+     */
+    void blitRow(int x, int y, int count) {
+        if (count <= 0) {
+            return;
+        }
+
+        if (fClip) {
+            int left = x;
+            int right = x + count;
+            if (this->clipRow(y, &left, &right)) {
+                this->blend(left, y, right - left, fClip->getAddr(left - fClipLeft, y - fClipTop));
+            }
+        } else {
+            this->blend(x, y, count, nullptr);
+        }
+    }
+
+    /* blitPixel()
+     * blend pixel (x, y), partially covered: (coverage) of 255 is fully covered
+     */
+    void blitPixel(int x, int y, unsigned coverage) {
+        coverage = std::min(coverage, 255u);
+        if (fClip) {
+            int left = x;
+            int right = x + 1;
+            if (!this->clipRow(y, &left, &right)) {
+                return;
+            }
+            coverage = div255(coverage * *fClip->getAddr(x - fClipLeft, y - fClipTop));
+        }
+        if (coverage == 0) {
+            return;
+        }
+
+        uint8_t c = uint8_t(coverage);
+        this->blend(x, y, 1, &c);
+    }
+
+    /* blitCoverage()
+     * blend pixels [x, x + count) on row y, each partially covered by coverage[i] (255 is fully
+     * covered)
+     */
+    void blitCoverage(int x, int y, int count, const uint8_t coverage[]) {
+        if (count <= 0) {
+            return;
+        }
+
+        if (fClip) {
+            int left = x;
+            int right = x + count;
+            if (!this->clipRow(y, &left, &right)) {
+                return;
+            }
+
+            int n = right - left;
+            if (fCoverage.size() < size_t(n)) {
+                fCoverage.resize(n);
+            }
+            const uint8_t* clip = fClip->getAddr(left - fClipLeft, y - fClipTop);
+            const uint8_t* covered = coverage + (left - x);
+            for (int i = 0; i < n; i++) {
+                fCoverage[i] = uint8_t(div255(unsigned(covered[i]) * clip[i]));
+            }
+            this->blend(left, y, n, fCoverage.data());
+            return;
+        }
+        this->blend(x, y, count, coverage);
+    }
+
+private:
+    const GBitmap fDevice;
+    const GMask* fAlphaDevice = nullptr;
+    GTiledBitmap* fTiledDevice = nullptr;
+    const GMask* fClip = nullptr;
+    int fClipLeft = 0;
+    int fClipTop = 0;
+    GShader* fShader;
+    GPixel fColor;
+    GBlendMode fMode;
+
+    // scratch storage for shaded rows, clipped coverage and alpha-only pixels
+    std::vector<GPixel> fRow;
+    std::vector<uint8_t> fCoverage;
+    std::vector<GPixel> fAlphaRow;
+
+    /* clipRow()
+     * limit [*left, *right) on row y to the clip's box; returns false if nothing's left
+     */
+    bool clipRow(int y, int* left, int* right) const {
+        if ((y < fClipTop) || (y >= fClipTop + fClip->height())) {
+            return false;
+        }
+        *left = std::max(*left, fClipLeft);
+        *right = std::min(*right, fClipLeft + fClip->width());
+        return *left < *right;
+    }
+
+    /* blend()
+     * blend pixels [x, x + count) on row y, covered by coverage[i] (fully if it's null); a
+     * shader is only run for the pixels between uncovered runs
+     */
+    void blend(int x, int y, int count, const uint8_t coverage[]) {
+        if (!fShader || !coverage) {
+            this->blendRun(x, y, count, coverage);
+            return;
+        }
+
+        int i = coverage_run(coverage, 0, count, 0);
+        while (i < count) {
+            // up to the next run of uncovered pixels
+            int end = i + 1;
+            while ((end < count) && (coverage[end] != 0)) {
+                end++;
+            }
+            this->blendRun(x + i, y, end - i, coverage + i);
+            i = coverage_run(coverage, end, count, 0);
+        }
+    }
+
+    /* blendRun()
+     * blend pixels [x, x + count) on row y, covered by coverage[i] (fully if it's null)
+     */
+    void blendRun(int x, int y, int count, const uint8_t coverage[]) {
+        const GPixel* src = nullptr;
+        if (fShader) {
+            if (fRow.size() < size_t(count)) {
+                fRow.resize(count);
+            }
+            fShader->shadeRow(x, y, count, fRow.data());
+            src = fRow.data();
+        }
+
+        // tiled: a run per tile it crosses, skipping tiles it leaves uncovered (so they aren't
+        // allocated)
+        if (fTiledDevice) {
+            constexpr int kTile = GTiledBitmap::kTileSize;
+            int ty = y / kTile;
+            for (int i = 0; i < count;) {
+                int tx = (x + i) / kTile;
+                int n = std::min(count - i, ((tx + 1) * kTile) - (x + i));
+                const uint8_t* covered = coverage ? coverage + i : nullptr;
+                if (!covered || (coverage_run(covered, 0, n, 0) < n)) {
+                    GPixel* dst = fTiledDevice->writeTile(tx, ty) + ((y % kTile) * kTile) + ((x + i) % kTile);
+                    this->blendPixels(src ? src + i : nullptr, dst, covered, n);
+                }
+                i += n;
+            }
+            return;
+        }
+
+        // alpha-only: its alpha is blended as pixels of just that alpha
+        GPixel* dst = nullptr;
+        uint8_t* alpha = nullptr;
+        if (fAlphaDevice) {
+            if (fAlphaRow.size() < size_t(count)) {
+                fAlphaRow.resize(count);
+            }
+            alpha = fAlphaDevice->getAddr(x, y);
+            dst = fAlphaRow.data();
+            for (int i = 0; i < count; i++) {
+                dst[i] = GPixel_PackARGB(alpha[i], 0, 0, 0);
+            }
+        } else {
+            dst = fDevice.getAddr(x, y);
+        }
+
+        this->blendPixels(src, dst, coverage, count);
+
+        if (alpha) {
+            for (int i = 0; i < count; i++) {
+                alpha[i] = uint8_t(GPixel_GetA(dst[i]));
+            }
+        }
+    }
+
+    /* blendPixels()
+     * blend src[count] (the color if it's null) into dst[count], covered by coverage[i] (fully
+     * if it's null)
+     */
+    void blendPixels(const GPixel src[], GPixel dst[], const uint8_t coverage[], int count) {
+        if (coverage && src) {
+            blend_row(fMode, src, dst, coverage, count);
+        } else if (coverage) {
+            blend_row(fMode, fColor, dst, coverage, count);
+        } else if (src) {
+            blend_row(fMode, src, dst, count);
+        } else {
+            blend_row(fMode, fColor, dst, count);
+        }
+    }
+};
+
+#endif
@@ -8,21 +8,51 @@
 #include "triangle_bitmap.h"
 #include "composite_triangle.h"
 #include "quad.h"
+#include "coons.h"
+#include "blitter.h"
+#include "triangle.h"
+#include "thread_pool.h"
+#include "hairline.h"
+#include "rrect.h"
+#include "mask.h"
 
 #include <vector>
 #include <algorithm>
 #include <iostream>
 
+// meshes with at least this many triangles are drawn with drawColorMeshTiled()
+constexpr int kTiledMeshMinTriangles = 256;
+
+// size (pixels) of the screen tiles meshes are binned into
+constexpr int kMeshTileSize = 64;
+
+// most (triangle, tile) pairs a mesh is binned into; past this it's drawn sequentially
+constexpr size_t kMeshMaxBinEntries = 1 << 22;
+
+// points of a polyline mapped to the device at a time (on the stack)
+constexpr int kPolylineChunk = 256;
+
+// drawPoints() markers mapped to the device at a time (on the stack)
+constexpr int kPointsChunk = 256;
+
+// at least this many points (solid colored) are drawn with drawPointsBanded()
+constexpr int kBandedPointsMin = 1 << 15;
+
+// height (rows) of the device bands points are binned into
+constexpr int kPointBandRows = 16;
+
 /***** MATRIX STACK METHODS *****/
 
 /* save() */
 void MyCanvas::save() {
     matrices.push(matrices.top());
+    clips.push(clips.top());
 }
 
 /* restore() */
 void MyCanvas::restore() {
     matrices.pop();
+    clips.pop();
 }
 
 /* concat() */
@@ -30,6 +60,66 @@ void MyCanvas::concat(const GMatrix& matrix) {
     matrices.top() = matrices.top() * matrix;
 }
 
+/* clipMask()
+ * the new clip covers the box of the device the mask may cover (see mask.h), within the
+ * current clip's: the mask's coverage of each pixel, times the current clip's
+ */
+void MyCanvas::clipMask(const GMask& mask, float x, float y) {
+    const Clip& current = clips.top();
+    GIRect box = GIRect::WH(fDevice.width(), fDevice.height());
+    if (current.mask.pixels()) {
+        box = GIRect::XYWH(current.left, current.top, current.mask.width(), current.mask.height());
+    }
+
+    GMatrix placed = matrices.top() * GMatrix::Translate(x, y);
+    auto inverse = placed.invert();
+    GIRect covered;
+    if (!inverse || !mask_box(mask, placed, fDevice.width(), fDevice.height(), &covered)) {
+        covered = GIRect::WH(0, 0);
+    }
+    box = GIRect::LTRB(std::max(box.left, covered.left), std::max(box.top, covered.top),
+                       std::min(box.right, covered.right), std::min(box.bottom, covered.bottom));
+
+    // (an empty box still has pixels: it's a clip that covers nothing)
+    Clip clip;
+    if (box.isEmpty()) {
+        box = GIRect::WH(0, 0);
+    }
+    clip.mask.alloc(box.width(), box.height());
+    clip.left = box.left;
+    clip.top = box.top;
+
+    for (int row = 0; row < clip.mask.height(); row++) {
+        int dy = clip.top + row;
+        uint8_t* pixels = clip.mask.getAddr(0, row);
+        sample_mask_row(mask, *inverse, clip.left, dy, clip.mask.width(), pixels);
+        if (current.mask.pixels()) {
+            const uint8_t* currentRow = current.mask.getAddr(clip.left - current.left, dy - current.top);
+            for (int i = 0; i < clip.mask.width(); i++) {
+                pixels[i] = uint8_t(div255(unsigned(pixels[i]) * currentRow[i]));
+            }
+        }
+    }
+    clips.top() = clip;
+}
+
+/* makeBlitter()
+ * a blitter for the paint into the device (or alpha-only or tiled device), through the clip
+ */
+Blitter MyCanvas::makeBlitter(const GPaint& paint) {
+    Blitter blitter(fDevice, paint);
+    if (fAlphaDevice.pixels()) {
+        blitter.setAlphaDevice(&fAlphaDevice);
+    }
+    if (fTiledDevice.width() > 0) {
+        blitter.setTiledDevice(&fTiledDevice);
+    }
+    if (clips.top().mask.pixels()) {
+        blitter.setClip(&clips.top().mask, clips.top().left, clips.top().top);
+    }
+    return blitter;
+}
+
 /***** DRAW METHODS *****/
 
 /* clear()
@@ -41,6 +131,23 @@ void MyCanvas::clear(const GColor& color) {
     int width = fDevice.width();
     int height = fDevice.height();
 
+    // tiled: every tile is freed, and reads as the color until drawn into again
+    if ((fTiledDevice.width() > 0) && !clips.top().mask.pixels()) {
+        fTiledDevice.clear(newPixel);
+        return;
+    }
+
+    // clipped, alpha-only or tiled: through the blitter
+    if (clips.top().mask.pixels() || fAlphaDevice.pixels() || (fTiledDevice.width() > 0)) {
+        GPaint paint(color);
+        paint.setBlendMode(GBlendMode::kSrc);
+        Blitter blitter = this->makeBlitter(paint);
+        for (int y = 0; y < height; y++) {
+            blitter.blitRow(0, y, width);
+        }
+        return;
+    }
+
     GPixel* curr_row = nullptr;
 
     for (int y = 0; y < height; y++) {
@@ -52,9 +159,15 @@ void MyCanvas::clear(const GColor& color) {
 }
 
 /* drawRect()
- * calls drawConvexPolygon
+ * calls drawRects (axis-aligned) or drawConvexPolygon
  */
 void MyCanvas::drawRect(const GRect& rect, const GPaint& color) {
+    const GMatrix& ctm = matrices.top();
+    if ((ctm[1] == 0) && (ctm[2] == 0)) {
+        drawRects(&rect, 1, color);
+        return;
+    }
+
     GPoint tl, tr, bl, br;
 
     tl.x = rect.left;
@@ -74,6 +187,41 @@ void MyCanvas::drawRect(const GRect& rect, const GPaint& color) {
     MyCanvas::drawConvexPolygon(points,4,color);
 }
 
+/* drawRects()
+ * with an axis-aligned CTM, a rect stays a rect on the device: the paint is set up once
+ * (blend mode reduced, shader context set), then every rect is mapped and filled row by row
+ * (see blit_rrect()), with no edges. Otherwise they're drawn one at a time.
+ */
+void MyCanvas::drawRects(const GRect rects[], int count, const GPaint& paint) {
+    const GMatrix& ctm = matrices.top();
+    if ((ctm[1] != 0) || (ctm[2] != 0)) {
+        GCanvas::drawRects(rects, count, paint);
+        return;
+    }
+
+    GPaint reduced = paint;
+    reduced.setBlendMode(get_optimized_blend(paint));
+    if ((count <= 0) || (reduced.getBlendMode() == GBlendMode::kDst)) {
+        return;
+    }
+
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(ctm)) {
+        return;
+    }
+
+    int width = fDevice.width();
+    int height = fDevice.height();
+    Blitter blitter = this->makeBlitter(reduced);
+
+    for (int i = 0; i < count; i++) {
+        RRect rect = rrect_make(rects[i], 0, 0, ctm[0], ctm[3], ctm[4], ctm[5]);
+        if (rrect_visible(rect, width, height)) {
+            blit_rrect(rect, 0, height, width, blitter);
+        }
+    }
+}
+
 /* drawConvexPolygon() */
 void MyCanvas::drawConvexPolygon(const GPoint* points, int count, const GPaint& paint) {
     // GBlendMode optBlendMode = get_optimized_blend(paint);
@@ -84,201 +232,265 @@ void MyCanvas::drawConvexPolygon(const GPoint* points, int count, const GPaint&
         std::vector<Edge> edges;
         get_edges(&edges, points, count, fDevice.width(), fDevice.height(), ctm);
 
-        // if still a polygon...
-        if (edges.size() >= 2) {
-            Edge edge1 = edges[0];
-            Edge edge2 = edges[1];
-            int nextEdge = 2;
+        fillConvex(edges, paint);
+    }
+}
 
-            // get top (first row) and bottom (last row)
-            int top = fDevice.height();
-            int bottom = 0;
-            for (int i = 0; i < edges.size(); i++) {
-                
-                // assign top
-                if (edges[i].top < top) {
-                    top = edges[i].top;
-                }
+/* fillConvex()
+ * fill the region between sorted (see edge_sort()) edges of a convex polygon: every row
+ * crosses exactly two of them, so each row is one run between the current pair of edges,
+ * and an edge that ends is replaced by the next one to start
+ */
+void MyCanvas::fillConvex(const std::vector<Edge>& edges, const GPaint& paint) {
 
-                // assign bottom
-                if (edges[i].bottom > bottom) {
-                    bottom = edges[i].bottom;
-                }
-            }
+    // if still a polygon...
+    if (edges.size() < 2) {
+        return;
+    }
 
-            GPixel* curr_row = nullptr;
-            GShader* shader = paint.peekShader();
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
 
-            // use shader: paint.peekShader()
-            if (shader) {
-                bool validContext = (*shader).setContext(matrices.top());
+    Edge edge1 = edges[0];
+    Edge edge2 = edges[1];
+    size_t nextEdge = 2;
 
-                if (validContext) {
-                    
-                    // for each row... 
-                    for (int y = top; y < bottom; y++) {
+    // the first row is the top of the first edges; the last is the bottom of the lowest
+    int top = edge1.top;
+    int bottom = 0;
+    for (const Edge& e : edges) {
+        bottom = std::max(bottom, e.bottom);
+    }
 
-                        float y_ray = float(y + 0.5);
-                        float x1 = edge1.eval_x(y_ray);
-                        float x2 = edge2.eval_x(y_ray);
+    Blitter blitter = this->makeBlitter(paint);
 
-                        int left = int(round(std::min(x1, x2)));
-                        int right = int(round(std::max(x1, x2)));
-                        int count = right - left;
+    // for each row...
+    for (int y = top; y < bottom; y++) {
+        float y_ray = float(y + 0.5);
+        float x1 = edge1.eval_x(y_ray);
+        float x2 = edge2.eval_x(y_ray);
 
-                        if (left < right) {
+        int left = int(round(std::min(x1, x2)));
+        int right = int(round(std::max(x1, x2)));
+        blitter.blitRow(left, y, right - left);
 
-                            curr_row = fDevice.getAddr(left,y);
-                            GPixel src[count];
-                            (*shader).shadeRow(left,y,count,src);
+        // replace "expired" edges (whether or not this row had any pixels)
+        if (edge1.bottom <= y + 1) {
+            if (nextEdge >= edges.size()) {
+                break;
+            }
+            edge1 = edges[nextEdge++];
+        }
+        if (edge2.bottom <= y + 1) {
+            if (nextEdge >= edges.size()) {
+                break;
+            }
+            edge2 = edges[nextEdge++];
+        }
+    }
+}
 
-                            for (int x = 0; x < count; x++) {
+/* drawPolyline()
+ * hairlines (see hairline.h): the points are mapped to the device a chunk at a time, and each
+ * segment is stepped straight into the blitter
+ */
+void MyCanvas::drawPolyline(const GPoint pts[], int count, const GPaint& paint) {
+    if ((count < 2) || (paint.getBlendMode() == GBlendMode::kDst)) {
+        return;
+    }
 
-                                // curr_row[x] = src[x];
-                                
-                                switch (optBlendMode) {
-                                    case GBlendMode::kClear:
-                                        curr_row[x] = GPixel_PackARGB(0,0,0,0);
-                                        break;
-                                    
-                                    case GBlendMode::kSrc:
-                                        curr_row[x] = src[x];
-                                        break;
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
 
-                                    case GBlendMode::kSrcOver:
-                                        curr_row[x] = blend_kSrcOver(&src[x],&curr_row[x]);
-                                        break;
+    Blitter blitter = this->makeBlitter(paint);
+    GPoint dev[kPolylineChunk];
+    HairlineJoint joint;
 
-                                    case GBlendMode::kDstOver:
-                                        curr_row[x] = blend_kDstOver(&src[x],&curr_row[x]);
-                                        break;
+    // consecutive chunks share their end point
+    for (int start = 0; start + 1 < count; start += kPolylineChunk - 1) {
+        int n = std::min(kPolylineChunk, count - start);
+        matrices.top().mapPoints(dev, pts + start, n);
 
-                                    case GBlendMode::kSrcIn:
-                                        curr_row[x] = blend_kSrcIn(&src[x],&curr_row[x]);
-                                        break;
+        for (int i = 0; i + 1 < n; i++) {
+            hairline(dev[i], dev[i + 1], fDevice.width(), fDevice.height(), paint.isAntiAlias(), blitter, &joint);
+        }
+    }
+}
 
-                                    case GBlendMode::kDstIn:
-                                        curr_row[x] = blend_kDstIn(&src[x],&curr_row[x]);
-                                        break;
+/* drawOval()
+ * a rounded rect that's all corners, when its spans can be solved for (see drawRRect);
+ * otherwise filled as the oval's own path, as GCanvas does (not the rounded rect's)
+ */
+void MyCanvas::drawOval(const GRect& rect, const GPaint& paint) {
+    const GMatrix& ctm = matrices.top();
+    if ((ctm[1] != 0) || (ctm[2] != 0) || paint.isAntiAlias()) {
+        GCanvas::drawOval(rect, paint);
+        return;
+    }
+    this->drawRRect(rect, rect.width() / 2, rect.height() / 2, paint);
+}
 
-                                    case GBlendMode::kSrcOut:
-                                        curr_row[x] = blend_kSrcOut(&src[x],&curr_row[x]);
-                                        break;
+/* drawRRect()
+ * with an axis-aligned CTM, the spans are solved for row by row (see rrect.h); otherwise, or
+ * anti-aliased, the rounded rect is filled as a path
+ */
+void MyCanvas::drawRRect(const GRect& rect, float rx, float ry, const GPaint& paint) {
+    const GMatrix& ctm = matrices.top();
+    if ((ctm[1] != 0) || (ctm[2] != 0) || paint.isAntiAlias()) {
+        GCanvas::drawRRect(rect, rx, ry, paint);
+        return;
+    }
 
-                                    case GBlendMode::kDstOut:
-                                        curr_row[x] = blend_kDstOut(&src[x],&curr_row[x]);
-                                        break;
+    if (paint.getBlendMode() != GBlendMode::kDst) {
+        fillRRect(rrect_make(rect, rx, ry, ctm[0], ctm[3], ctm[4], ctm[5]), paint);
+    }
+}
 
-                                    case GBlendMode::kSrcATop:
-                                        curr_row[x] = blend_kSrcATop(&src[x],&curr_row[x]);
-                                        break;
+/* fillRRect()
+ * fill the device space rounded rect a row at a time
+ */
+void MyCanvas::fillRRect(const RRect& rr, const GPaint& paint) {
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
 
-                                    case GBlendMode::kDstATop:
-                                        curr_row[x] = blend_kDstATop(&src[x],&curr_row[x]);
-                                        break;
+    Blitter blitter = this->makeBlitter(paint);
+    blit_rrect(rr, 0, fDevice.height(), fDevice.width(), blitter);
+}
 
-                                    case GBlendMode::kXor:
-                                        curr_row[x] = blend_kXor(&src[x],&curr_row[x]);
-                                        break;
-                                }
+/* drawPoints()
+ * with an axis-aligned CTM every marker is a device space rect or oval of the same size:
+ * the points are mapped a chunk at a time, the ones off the device dropped, and the rest
+ * filled straight through one blitter (see rrect.h). Otherwise, or for anti-aliased discs,
+ * the markers are drawn one at a time.
+ */
+void MyCanvas::drawPoints(const GPoint pts[], int count, float size, const GPaint& paint) {
+    const GMatrix& ctm = matrices.top();
+    bool aaDiscs = paint.isAntiAlias() && (paint.getPointShape() == GPointShape::kDisc);
+    if ((ctm[1] != 0) || (ctm[2] != 0) || aaDiscs) {
+        GCanvas::drawPoints(pts, count, size, paint);
+        return;
+    }
 
-                            }
+    if ((count <= 0) || !(size > 0) || (paint.getBlendMode() == GBlendMode::kDst)) {
+        return;
+    }
 
-                            // if edge1 is "expired"
-                            if (edge1.bottom < y + 1.5) {
-                                edge1 = edges[nextEdge];
-                                nextEdge += 1;
-                            }
-                            
-                            // if edge2 is "expired"
-                            if (edge2.bottom < y + 1.5) {
-                                edge2 = edges[nextEdge];
-                                nextEdge += 1;
-                            }
-                        }
-                        
-                    }
-                }
-            }
-            
-            // use color: paint.getColor()
-            else {
-                // for each row... 
-                for (int y = top; y < bottom; y++) {
-                    curr_row = fDevice.getAddr(0,y);
+    // lots of solid colored points are split up across threads
+    if ((count >= kBandedPointsMin) && drawPointsBanded(pts, count, size, paint)) {
+        return;
+    }
 
-                    float y_ray = float(y + 0.5);
-                    float x1 = edge1.eval_x(y_ray);
-                    float x2 = edge2.eval_x(y_ray);
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(ctm)) {
+        return;
+    }
 
-                    int left = int(round(std::min(x1, x2)));
-                    int right = int(round(std::max(x1, x2)));
+    int width = fDevice.width();
+    int height = fDevice.height();
+    float hx = std::abs(ctm[0]) * size / 2;
+    float hy = std::abs(ctm[3]) * size / 2;
+    bool disc = paint.getPointShape() == GPointShape::kDisc;
 
-                    for (int x = left; x < right; x++) {
+    Blitter blitter = this->makeBlitter(paint);
+    GPoint dev[kPointsChunk];
 
-                        switch (optBlendMode) {
-                            case GBlendMode::kClear:
-                                curr_row[x] = GPixel_PackARGB(0,0,0,0);
-                                break;
-                            
-                            case GBlendMode::kSrc:
-                                curr_row[x] = convertColor2Pixel(paint.getColor());
-                                break;
+    for (int start = 0; start < count; start += kPointsChunk) {
+        int n = std::min(kPointsChunk, count - start);
+        ctm.mapPoints(dev, pts + start, n);
+
+        for (int i = 0; i < n; i++) {
+            RRect marker = rrect_marker(dev[i], hx, hy, disc);
+            if (rrect_visible(marker, width, height)) {
+                blit_rrect(marker, 0, height, width, blitter);
+            }
+        }
+    }
+}
 
-                            case GBlendMode::kSrcOver:
-                                curr_row[x] = blend_kSrcOver(paint.getColor(),&curr_row[x]);
-                                break;
+/* drawPointsBanded()
+ * draw (solid colored) points by binning them into bands of rows and filling the bands
+ * concurrently. Each band draws its points in order, so the result is identical to drawing
+ * them one after another (see drawColorMeshTiled()). The CTM must be axis-aligned.
+ *
+ * Returns false if the points should be drawn sequentially instead.
+ */
+bool MyCanvas::drawPointsBanded(const GPoint pts[], int count, float size, const GPaint& paint) {
+    ThreadPool& pool = ThreadPool::Shared();
+    if ((pool.threadCount() < 2) || (paint.peekShader() != nullptr)) {
+        return false;
+    }
 
-                            case GBlendMode::kDstOver:
-                                curr_row[x] = blend_kDstOver(paint.getColor(),&curr_row[x]);
-                                break;
+    const GMatrix& ctm = matrices.top();
+    int width = fDevice.width();
+    int height = fDevice.height();
+    int bands = (height + kPointBandRows - 1) / kPointBandRows;
+    float hx = std::abs(ctm[0]) * size / 2;
+    float hy = std::abs(ctm[3]) * size / 2;
+    bool disc = paint.getPointShape() == GPointShape::kDisc;
+
+    std::vector<GPoint> dev(count);
+    ctm.mapPoints(dev.data(), pts, count);
+
+    // bin into every band the marker's rows touch
+    std::vector<std::vector<int>> bins(bands);
+    for (int i = 0; i < count; i++) {
+        RRect marker = rrect_marker(dev[i], hx, hy, disc);
+        if (!rrect_visible(marker, width, height)) {
+            continue;
+        }
 
-                            case GBlendMode::kSrcIn:
-                                curr_row[x] = blend_kSrcIn(paint.getColor(),&curr_row[x]);
-                                break;
+        int b0 = int(std::max(marker.rect.top, 0.0f)) / kPointBandRows;
+        int b1 = int(std::min(marker.rect.bottom, float(height - 1))) / kPointBandRows;
+        for (int b = b0; b <= b1; b++) {
+            bins[b].push_back(i);
+        }
+    }
 
-                            case GBlendMode::kDstIn:
-                                curr_row[x] = blend_kDstIn(paint.getColor(),&curr_row[x]);
-                                break;
+    pool.parallelFor(bands, [&](int b) {
+        int top = b * kPointBandRows;
+        int bottom = std::min(height, top + kPointBandRows);
 
-                            case GBlendMode::kSrcOut:
-                                curr_row[x] = blend_kSrcOut(paint.getColor(),&curr_row[x]);
-                                break;
+        Blitter blitter = this->makeBlitter(paint);
+        for (int i : bins[b]) {
+            blit_rrect(rrect_marker(dev[i], hx, hy, disc), top, bottom, width, blitter);
+        }
+    });
 
-                            case GBlendMode::kDstOut:
-                                curr_row[x] = blend_kDstOut(paint.getColor(),&curr_row[x]);
-                                break;
+    return true;
+}
 
-                            case GBlendMode::kSrcATop:
-                                curr_row[x] = blend_kSrcATop(paint.getColor(),&curr_row[x]);
-                                break;
+/* drawMask()
+ * each row of the device the mask covers is sampled from it (see mask.h), then blended with
+ * that coverage
+ */
+void MyCanvas::drawMask(const GMask& mask, float x, float y, const GPaint& paint) {
+    if (!mask.pixels() || (paint.getBlendMode() == GBlendMode::kDst)) {
+        return;
+    }
 
-                            case GBlendMode::kDstATop:
-                                curr_row[x] = blend_kDstATop(paint.getColor(),&curr_row[x]);
-                                break;
+    GMatrix placed = matrices.top() * GMatrix::Translate(x, y);
+    auto inverse = placed.invert();
+    GIRect box;
+    if (!inverse || !mask_box(mask, placed, fDevice.width(), fDevice.height(), &box)) {
+        return;
+    }
 
-                            case GBlendMode::kXor:
-                                curr_row[x] = blend_kXor(paint.getColor(),&curr_row[x]);
-                                break;
-                        }
-                    
-                    }
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
 
-                    // if edge1 is "expired"
-                    if (edge1.bottom < y + 1.5) {
-                        edge1 = edges[nextEdge];
-                        nextEdge += 1;
-                    }
-                    
-                    // if edge2 is "expired"
-                    if (edge2.bottom < y + 1.5) {
-                        edge2 = edges[nextEdge];
-                        nextEdge += 1;
-                    }
-                }
-                
-            }
-        }
+    Blitter blitter = this->makeBlitter(paint);
+    std::vector<uint8_t> coverage(box.width());
+    for (int dy = box.top; dy < box.bottom; dy++) {
+        sample_mask_row(mask, *inverse, box.left, dy, box.width(), coverage.data());
+        blitter.blitCoverage(box.left, dy, box.width(), coverage.data());
     }
 }
 
@@ -519,22 +731,172 @@ void MyCanvas::drawPath(const GPath& path, const GPaint& paint) {
 }
 */
 
+/* drawColorMeshTiled()
+ * draw a mesh with per-vertex colors (no textures) by binning its triangles into screen tiles
+ * and rasterizing the tiles concurrently. Each tile draws its triangles in submission order,
+ * so the result is identical to drawing the triangles one after another.
+ *
+ * Only color meshes take this path: their shaders are per-triangle and only read during
+ * shadeRow(), whereas texture meshes share (and re-setContext) the paint's shader.
+ *
+ * Returns false if the mesh should be drawn sequentially instead.
+ */
+bool MyCanvas::drawColorMeshTiled(const GPoint verts[], const GColor colors[], int count, const int indices[], const GPaint& paint) {
+    ThreadPool& pool = ThreadPool::Shared();
+    if (pool.threadCount() < 2) {
+        return false;
+    }
+
+    if (paint.getBlendMode() == GBlendMode::kDst) {
+        return true;
+    }
+
+    GMatrix ctm = matrices.top();
+    int width = fDevice.width();
+    int height = fDevice.height();
+    int tilesX = (width + kMeshTileSize - 1) / kMeshTileSize;
+    int tilesY = (height + kMeshTileSize - 1) / kMeshTileSize;
+
+    // set up every triangle's device points, shader and tiles up front (on this thread); the
+    // bins only cover the tiles the mesh touches, so a small mesh on a huge device is cheap
+    std::vector<GPoint> devVerts(3 * count);
+    std::vector<TriangleGradient> shaders;
+    shaders.reserve(count);
+    std::vector<GIRect> triTiles(count);
+    GIRect meshTiles = GIRect::LTRB(tilesX, tilesY, 0, 0);
+    size_t entries = 0;
+
+    for (int i = 0; i < count; i++) {
+        GPoint pVerts[3] = {verts[indices[3*i+0]], verts[indices[3*i+1]], verts[indices[3*i+2]]};
+        GColor theseColors[3] = {colors[indices[3*i+0]], colors[indices[3*i+1]], colors[indices[3*i+2]]};
+
+        GPoint* dVerts = &devVerts[3*i];
+        ctm.mapPoints(dVerts, pVerts, 3);
+
+        triTiles[i] = GIRect::LTRB(0, 0, 0, 0);
+        shaders.emplace_back(pVerts, theseColors);
+        if (!shaders.back().setContext(ctm)) {
+            continue;
+        }
+
+        // out of range for the half-space rasterizer: let the sequential path handle it
+        for (int k = 0; k < 3; k++) {
+            if (!(std::abs(dVerts[k].x) < kTriMaxCoord) || !(std::abs(dVerts[k].y) < kTriMaxCoord)) {
+                return false;
+            }
+        }
+
+        // every tile on the device the triangle's bounds touch
+        float minX = std::min({dVerts[0].x, dVerts[1].x, dVerts[2].x});
+        float maxX = std::max({dVerts[0].x, dVerts[1].x, dVerts[2].x});
+        float minY = std::min({dVerts[0].y, dVerts[1].y, dVerts[2].y});
+        float maxY = std::max({dVerts[0].y, dVerts[1].y, dVerts[2].y});
+
+        int tx0 = std::max(0, int(floor(minX / kMeshTileSize)));
+        int tx1 = std::min(tilesX - 1, int(floor(maxX / kMeshTileSize)));
+        int ty0 = std::max(0, int(floor(minY / kMeshTileSize)));
+        int ty1 = std::min(tilesY - 1, int(floor(maxY / kMeshTileSize)));
+        if ((tx0 > tx1) || (ty0 > ty1)) {
+            continue;
+        }
+
+        // (a few huge triangles could land in millions of tiles)
+        entries += size_t(tx1 - tx0 + 1) * size_t(ty1 - ty0 + 1);
+        if (entries > kMeshMaxBinEntries) {
+            return false;
+        }
+
+        triTiles[i] = GIRect::LTRB(tx0, ty0, tx1 + 1, ty1 + 1);
+        meshTiles = GIRect::LTRB(std::min(meshTiles.left, tx0), std::min(meshTiles.top, ty0),
+                                 std::max(meshTiles.right, tx1 + 1), std::max(meshTiles.bottom, ty1 + 1));
+    }
+    if (meshTiles.isEmpty()) {
+        return true;
+    }
+
+    // bin (in submission order) over the tiles the mesh touches
+    int binsX = meshTiles.width();
+    std::vector<std::vector<int>> bins(size_t(binsX) * size_t(meshTiles.height()));
+    for (int i = 0; i < count; i++) {
+        const GIRect& r = triTiles[i];
+        for (int ty = r.top; ty < r.bottom; ty++) {
+            for (int tx = r.left; tx < r.right; tx++) {
+                bins[((ty - meshTiles.top) * binsX) + (tx - meshTiles.left)].push_back(i);
+            }
+        }
+    }
+
+    // only the tiles that have work
+    std::vector<int> tiles;
+    for (int t = 0; t < int(bins.size()); t++) {
+        if (!bins[t].empty()) {
+            tiles.push_back(t);
+        }
+    }
+
+    pool.parallelFor(int(tiles.size()), [&](int job) {
+        int t = tiles[job];
+        int tx = meshTiles.left + (t % binsX);
+        int ty = meshTiles.top + (t / binsX);
+        GIRect clip = GIRect::LTRB(tx * kMeshTileSize, ty * kMeshTileSize,
+                                   std::min(width, (tx + 1) * kMeshTileSize),
+                                   std::min(height, (ty + 1) * kMeshTileSize));
+
+        Blitter blitter = this->makeBlitter(paint);
+        for (int i : bins[t]) {
+            blitter.setShader(&shaders[i]);
+            rasterize_triangle(&devVerts[3*i], clip, blitter);
+        }
+    });
+
+    return true;
+}
+
 /* drawMesh() */
 void MyCanvas::drawMesh(const GPoint verts[], const GColor colors[], const GPoint texs[], int count, const int indices[], const GPaint& paint) {
-    
+
+    // texture coordinates are ignored if there is no shader to sample
+    if (paint.peekShader() == nullptr) {
+        texs = nullptr;
+    }
+
+    // large color-only meshes are binned into tiles and drawn in parallel
+    if ((colors != nullptr) && (texs == nullptr) && (count >= kTiledMeshMinTriangles)) {
+        if (drawColorMeshTiled(verts, colors, count, indices, paint)) {
+            return;
+        }
+    }
+
     // if something is specified
-    if ((colors != nullptr) || (texs != nullptr)) {
-        
+    if (((colors != nullptr) || (texs != nullptr)) && (paint.getBlendMode() != GBlendMode::kDst)) {
+
+        GMatrix ctm = matrices.top();
+        GIRect clip = GIRect::WH(fDevice.width(), fDevice.height());
+        Blitter blitter = this->makeBlitter(paint);
+
         int n = 0;
 
         // for each triangle
         for (int i = 0; i < count; i++) {
 
-            // get p vertices
+            // get p vertices (local and device)
             GPoint pVerts[3] = {verts[indices[n+0]], verts[indices[n+1]], verts[indices[n+2]]};
-
-            // create GPaint with correct blendmode
-            GPaint thisPaint = paint;
+            GPoint dVerts[3];
+            ctm.mapPoints(dVerts, pVerts, 3);
+
+            // rasterize the triangle with its shader
+            auto draw = [&](GShader& shader) {
+                if (shader.setContext(ctm)) {
+                    blitter.setShader(&shader);
+
+                    // out of range for the half-space rasterizer: use the edge list instead
+                    if (!rasterize_triangle(dVerts, clip, blitter)) {
+                        GPaint thisPaint = paint;
+                        thisPaint.setShader(std::shared_ptr<GShader>(&shader, [](GShader*) {}));
+                        drawConvexPolygon(pVerts, 3, thisPaint);
+                    }
+                }
+            };
 
             // overspecified (colors and textures)
             if ((colors != nullptr) && (texs != nullptr)) {
@@ -544,8 +906,8 @@ void MyCanvas::drawMesh(const GPoint verts[], const GColor colors[], const GPoin
                 // get colors
                 GColor theseColors[3] = {colors[indices[n+0]], colors[indices[n+1]], colors[indices[n+2]]};
 
-                // set CompositeTriangle as shader
-                thisPaint.setShader(std::shared_ptr<GShader>(new CompositeTriangle(paint.peekShader(),pVerts,tVerts,theseColors)));
+                CompositeTriangle shader(paint.peekShader(), pVerts, tVerts, theseColors);
+                draw(shader);
             }
 
             // only colors
@@ -553,8 +915,8 @@ void MyCanvas::drawMesh(const GPoint verts[], const GColor colors[], const GPoin
                 // get colors
                 GColor theseColors[3] = {colors[indices[n+0]], colors[indices[n+1]], colors[indices[n+2]]};
 
-                // set TriangleGradient as shader
-                thisPaint.setShader(std::shared_ptr<GShader>(new TriangleGradient(pVerts, theseColors)));
+                TriangleGradient shader(pVerts, theseColors);
+                draw(shader);
             }
 
             // only textures
@@ -562,97 +924,91 @@ void MyCanvas::drawMesh(const GPoint verts[], const GColor colors[], const GPoin
                 // get t vertices
                 GPoint tVerts[3] = {texs[indices[n+0]], texs[indices[n+1]], texs[indices[n+2]]};
 
-                // set TriangleBitmap as shader
-                thisPaint.setShader(std::shared_ptr<GShader>(new TriangleBitmap(paint.peekShader(),pVerts,tVerts)));
+                TriangleBitmap shader(paint.peekShader(), pVerts, tVerts);
+                draw(shader);
             }
 
-            // call drawConvexPolygon()
-            drawConvexPolygon(pVerts, 3, thisPaint);
-
             n += 3;
         }
     }
 
 }
 
-/* drawQuad() */
+/* drawQuad()
+ * evaluate the shared lattice of points (and colors/texture coordinates) once, and draw it
+ * as a single indexed mesh
+ */
 void MyCanvas::drawQuad(const GPoint verts[4], const GColor colors[4], const GPoint texs[4], int level, const GPaint& paint) {
     
     // if something is specified
     if ((colors != nullptr) || (texs != nullptr)) {
 
-        // get u/v stops
-        float step = 1 / float(level + 1);
-
-        std::vector<float> stops;
-        stops.push_back(0);
-        float s = 0;
-        for (int i = 0; i < level; i++) {
-            stops.push_back(s += step);
+        // pick the level from the quad's size/shape on the device
+        if (level == kAutoLevel) {
+            GPoint dev[4];
+            matrices.top().mapPoints(dev, verts, 4);
+            level = auto_quad_level(dev);
         }
-        stops.push_back(1);
 
-        // define indices
-        int meshIndices[6] = {0, 1, 3, 1, 2, 3};
+        int n = level + 1;
+        int numVerts = (n + 1) * (n + 1);
+        int numTris = 2 * n * n;
 
-        float v1, v2, u1, u2;
-        for (int v = 0; v < level+1; v++) {
-            v1 = stops[v];
-            v2 = stops[v+1];
+        std::vector<GPoint> meshVerts(numVerts);
+        quad_lattice(verts, level, meshVerts.data());
 
-            for (int u = 0; u < level+1; u++) {
-                u1 = stops[u];
-                u2 = stops[u+1];
-
-                // overspecified (colors and textures)
-                if ((colors != nullptr) && (texs != nullptr)) {
-                    // get vertices
-                    GPoint meshVerts[4];
-                    getQuadPoints(verts, meshVerts, u1, u2, v1, v2);
+        std::vector<GColor> meshColors;
+        if (colors != nullptr) {
+            meshColors.resize(numVerts);
+            quad_lattice(colors, level, meshColors.data());
+        }
 
-                    // get colors
-                    GColor meshColors[4];
-                    getQuadColors(colors, meshColors, u1, u2, v1, v2);
+        std::vector<GPoint> meshTexs;
+        if (texs != nullptr) {
+            meshTexs.resize(numVerts);
+            quad_lattice(texs, level, meshTexs.data());
+        }
 
-                    // get texture coordinates
-                    GPoint meshTexs[4];
-                    getQuadPoints(texs, meshTexs, u1, u2, v1, v2);
+        std::vector<int> meshIndices(3 * numTris);
+        quad_indices(level, meshIndices.data());
 
-                    // draw
-                    drawMesh(meshVerts, meshColors, meshTexs, 2, meshIndices, paint);
-                }
+        drawMesh(meshVerts.data(),
+                 (colors != nullptr) ? meshColors.data() : nullptr,
+                 (texs != nullptr) ? meshTexs.data() : nullptr,
+                 numTris, meshIndices.data(), paint);
+    }
+}
 
-                // only colors
-                else if ((colors != nullptr) && (texs == nullptr)) {
-                    // get vertices
-                    GPoint meshVerts[4];
-                    getQuadPoints(verts, meshVerts, u1, u2, v1, v2);
+/* drawQuadraticCoons()
+ * build the lattice of positions and texture coordinates in one pass, and draw it as a
+ * single indexed mesh
+ */
+void MyCanvas::drawQuadraticCoons(const GPoint pts[8], const GPoint tex[4], int level, const GPaint& paint) {
 
-                    // get colors
-                    GColor meshColors[4];
-                    getQuadColors(colors, meshColors, u1, u2, v1, v2);
+    // pick the level from the patch's size/curvature on the device
+    if (level == kAutoLevel) {
+        GPoint dev[8];
+        matrices.top().mapPoints(dev, pts, 8);
+        level = auto_coons_level(dev);
+    }
 
-                    // draw
-                    drawMesh(meshVerts, meshColors, nullptr, 2, meshIndices, paint);
-                }
+    int n = level + 1;
+    int numVerts = (n + 1) * (n + 1);
+    int numTris = 2 * n * n;
 
-                // only textures
-                else if ((colors == nullptr) && (texs != nullptr)) {
-                    // get vertices
-                    GPoint meshVerts[4];
-                    getQuadPoints(verts, meshVerts, u1, u2, v1, v2);
+    std::vector<GPoint> verts(numVerts);
+    coons_lattice(pts, level, verts.data());
 
-                    // get texture coordinates
-                    GPoint meshTexs[4];
-                    getQuadPoints(texs, meshTexs, u1, u2, v1, v2);
+    std::vector<GPoint> texs;
+    if (tex != nullptr) {
+        texs.resize(numVerts);
+        quad_lattice(tex, level, texs.data());
+    }
 
-                    // draw
-                    drawMesh(meshVerts, nullptr, meshTexs, 2, meshIndices, paint);
-                }
+    std::vector<int> indices(3 * numTris);
+    quad_indices(level, indices.data());
 
-            }
-        }
-    }
+    drawMesh(verts.data(), nullptr, (tex != nullptr) ? texs.data() : nullptr, numTris, indices.data(), paint);
 }
 
 /* GCreateCanvas() */
@@ -660,6 +1016,22 @@ std::unique_ptr<GCanvas> GCreateCanvas(const GBitmap& device) {
     return std::unique_ptr<GCanvas>(new MyCanvas(device));
 }
 
+/* GCreateTiledCanvas() */
+std::unique_ptr<GCanvas> GCreateTiledCanvas(const GTiledBitmap& device) {
+    if (device.width() <= 0) {
+        return nullptr;
+    }
+    return std::unique_ptr<GCanvas>(new MyCanvas(device));
+}
+
+/* GCreateMaskCanvas() */
+std::unique_ptr<GCanvas> GCreateMaskCanvas(const GMask& device) {
+    if (!device.pixels()) {
+        return nullptr;
+    }
+    return std::unique_ptr<GCanvas>(new MyCanvas(device));
+}
+
 /* GDrawSomething() */
 std::string GDrawSomething(GCanvas* canvas, GISize dim) {
 
@@ -6,38 +6,104 @@
 #include "include/GColor.h"
 #include "include/GPaint.h"
 #include "include/GBitmap.h"
+#include "include/GMask.h"
+#include "include/GTiledBitmap.h"
 #include "include/GMatrix.h"
 #include "include/GShader.h"
 
 #include <stack>
+#include <vector>
+
+class Blitter;
+struct Edge;
+struct RRect;
+struct MaskSpan;
+
+/* Clip
+ * coverage of the device pixels in the mask's box, its top left at (left, top); none outside it
+ * (no clip at all if the mask has no pixels)
+ */
+struct Clip {
+    GMask mask;
+    int left = 0;
+    int top = 0;
+};
 
 class MyCanvas : public GCanvas {
 public:
     MyCanvas(const GBitmap& device) : fDevice(device), matrices() {
         GMatrix identity = GMatrix();
         matrices.push(identity);
+        clips.push(Clip());
+    }
+
+    // an alpha-only or tiled device: fDevice only has its size (see Blitter)
+    MyCanvas(const GMask& device)
+            : fDevice(device.width(), device.height(), size_t(device.width()) * 4, nullptr, false),
+              fAlphaDevice(device), matrices() {
+        GMatrix identity = GMatrix();
+        matrices.push(identity);
+        clips.push(Clip());
+    }
+
+    MyCanvas(const GTiledBitmap& device)
+            : fDevice(device.width(), device.height(), size_t(device.width()) * 4, nullptr, false),
+              fTiledDevice(device), matrices() {
+        GMatrix identity = GMatrix();
+        matrices.push(identity);
+        clips.push(Clip());
     }
 
     // DRAW FUNCTIONS
     void clear(const GColor& color) override;
 
     void drawRect(const GRect& rect, const GPaint& color) override;
+    void drawRects(const GRect rects[], int count, const GPaint& paint) override;
     void drawConvexPolygon(const GPoint* points, int count, const GPaint& paint) override;
     void drawPath(const GPath& path, const GPaint& paint) override;
+    void drawPathView(const GPathView& view, const GPaint& paint) override;
+    void drawPaths(const GPath* const paths[], int count, const GPaint& paint) override;
+    void drawPathInstances(const GPath& path, const GMatrix instances[], int count, const GPaint& paint) override;
+    void drawPolyline(const GPoint pts[], int count, const GPaint& paint) override;
+    void drawOval(const GRect& rect, const GPaint& paint) override;
+    void drawRRect(const GRect& rect, float rx, float ry, const GPaint& paint) override;
+    void drawPoints(const GPoint pts[], int count, float size, const GPaint& paint) override;
+    void drawMask(const GMask& mask, float x, float y, const GPaint& paint) override;
 
     void drawMesh(const GPoint verts[], const GColor colors[], const GPoint texs[],
                   int count, const int indices[], const GPaint& paint) override;
     void drawQuad(const GPoint verts[4], const GColor colors[4], const GPoint texs[4],
                   int level, const GPaint& paint) override;
+    void drawQuadraticCoons(const GPoint pts[8], const GPoint tex[4], int level,
+                            const GPaint& paint) override;
 
     // MATRIX FUNCTIONS
     void save() override;
     void restore() override;
     void concat(const GMatrix& matrix) override;
+    void clipMask(const GMask& mask, float x, float y) override;
 
 private:
     const GBitmap fDevice;
+    const GMask fAlphaDevice;
+    GTiledBitmap fTiledDevice;
     std::stack<GMatrix> matrices;
+    std::stack<Clip> clips;
+
+    Blitter makeBlitter(const GPaint& paint);
+
+    void fillPath(const GPath& path, const GMatrix& matrix, const GPaint& paint);
+    void fillPathAA(const GPath& path, const GMatrix& ctm, const GPaint& paint);
+    void pathEdges(const GPath& path, const GMatrix& ctm, std::vector<Edge>* edges);
+    void fillConvex(const std::vector<Edge>& edges, const GPaint& paint);
+    void fillEdges(const std::vector<Edge>& edges, const GPaint& paint);
+    void fillMask(const std::vector<MaskSpan>& spans, int dx, int dy, const GPaint& paint);
+    void fillEdgesMulti(const std::vector<Edge>& edges, const GPaint& paint);
+    void fillRRect(const RRect& rr, const GPaint& paint);
+
+    bool drawPointsBanded(const GPoint pts[], int count, float size, const GPaint& paint);
+    bool drawColorMeshTiled(const GPoint verts[], const GColor colors[], int count,
+                            const int indices[], const GPaint& paint);
 };
 
 #endif
\ No newline at end of file
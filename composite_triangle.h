@@ -17,28 +17,26 @@
 class CompositeTriangle : public GShader {
 public:
     /* constructor */
-    CompositeTriangle(GShader* bmshader, const GPoint pVerts[3], const GPoint tVerts[3], const GColor colors[3]) {
-        triGradient = new TriangleGradient(pVerts, colors);
-        triBitmap = new TriangleBitmap(bmshader, pVerts, tVerts);
-    }
+    CompositeTriangle(GShader* bmshader, const GPoint pVerts[3], const GPoint tVerts[3], const GColor colors[3]) :
+            triGradient(pVerts, colors), triBitmap(bmshader, pVerts, tVerts) {}
 
     /* isOpaque() */
     bool isOpaque() {
-        return triBitmap->isOpaque() && triGradient->isOpaque();
+        return triBitmap.isOpaque() && triGradient.isOpaque();
     }
     
     /* setContext () */
     bool setContext(const GMatrix& ctm) {
-        return triBitmap->setContext(ctm) && triGradient->setContext(ctm);
+        return triBitmap.setContext(ctm) && triGradient.setContext(ctm);
     }
 
     /* shadeRow() */
     void shadeRow(int x, int y, int count, GPixel row[]) {
         GPixel bm [count];
-        triBitmap->shadeRow(x, y, count, bm);
+        triBitmap.shadeRow(x, y, count, bm);
         
         GPixel gr [count];
-        triGradient->shadeRow(x, y, count, gr);
+        triGradient.shadeRow(x, y, count, gr);
 
         for (int i = 0; i < count; i++) {
             unsigned a = div255(GPixel_GetA(bm[i]) * GPixel_GetA(gr[i]));
@@ -51,8 +49,8 @@ public:
     }
 
 private:
-    TriangleGradient* triGradient;
-    TriangleBitmap* triBitmap;
+    TriangleGradient triGradient;
+    TriangleBitmap triBitmap;
 };
 
 #endif
\ No newline at end of file
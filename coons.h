@@ -0,0 +1,69 @@
+#ifndef COONS_DEFINED
+#define COONS_DEFINED
+
+#include "include/GPoint.h"
+
+#include <vector>
+
+/* quad_forward_diff()
+ * evaluate the quadratic bezier (a, b, c) at n + 1 evenly spaced t in [0, 1] by forward
+ * differencing: q(t) = At^2 + Bt + C has a constant second difference, so each step is two adds.
+ * The last point is set to c exactly.
+ */
+inline void quad_forward_diff(GPoint a, GPoint b, GPoint c, int n, GPoint out[]) {
+    float h = 1 / float(n);
+
+    GPoint A = a - b - b + c;
+    GPoint B = (b - a) * 2;
+
+    GPoint f = a;
+    GPoint d1 = (A * (h * h)) + (B * h);
+    GPoint d2 = A * (2 * h * h);
+
+    for (int i = 0; i < n; i++) {
+        out[i] = f;
+        f += d1;
+        d1 += d2;
+    }
+    out[n] = c;
+}
+
+/* coons_lattice()
+ * evaluate the coons patch of quadratic sides (layout as in GFinal::drawQuadraticCoons) at
+ * (level + 2) x (level + 2) lattice points, stored row by row in lattice[].
+ *
+ *  value(u,v) = TB(u,v) + LR(u,v) - Corners(u,v)
+ *
+ * The 4 sides are forward differenced once. Within a row (fixed v), LR - Corners is linear in u
+ * and is forward differenced too, so each lattice point costs a handful of adds.
+ */
+inline void coons_lattice(const GPoint pts[8], int level, GPoint lattice[]) {
+    int n = level + 1;
+    float h = 1 / float(n);
+
+    std::vector<GPoint> top(n + 1), bottom(n + 1), left(n + 1), right(n + 1);
+    quad_forward_diff(pts[0], pts[1], pts[2], n, top.data());
+    quad_forward_diff(pts[6], pts[5], pts[4], n, bottom.data());
+    quad_forward_diff(pts[0], pts[7], pts[6], n, left.data());
+    quad_forward_diff(pts[2], pts[3], pts[4], n, right.data());
+
+    for (int v = 0; v <= n; v++) {
+        float t = (v == n) ? 1 : (v * h);
+
+        // corners, interpolated down the left (0 -> 6) and right (2 -> 4) sides
+        GPoint c0 = (pts[0] * (1 - t)) + (pts[6] * t);
+        GPoint c1 = (pts[2] * (1 - t)) + (pts[4] * t);
+
+        // LR - Corners = e + (u * f)
+        GPoint e = left[v] - c0;
+        GPoint df = ((right[v] - left[v]) - (c1 - c0)) * h;
+
+        GPoint* row = &lattice[v * (n + 1)];
+        for (int u = 0; u <= n; u++) {
+            row[u] = (top[u] * (1 - t)) + (bottom[u] * t) + e;
+            e += df;
+        }
+    }
+}
+
+#endif
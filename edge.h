@@ -8,19 +8,25 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <utility>
 
 struct Edge {
     int top, bottom;
     float m, b;
     int w;
 
+    // which of the paths filled together (see drawPaths()) the edge belongs to
+    int path = 0;
+
     // return the X value for a given Y value
     float eval_x(float y) const {
         return (m * y) + b;
     }
 
+    // whether the edge covers row y: rows [top, bottom), so consecutive edges sharing an
+    // end point don't both count on the shared row
     bool isValid(int y) {
-        return (y >= top) && (y <= bottom);
+        return (y >= top) && (y < bottom);
     }
     
 };
@@ -139,18 +145,23 @@ inline bool valid_bounds(GRect bounds, int width, int height) {
 
 /* ========== PROCESS SEGMENTS ========== */
 
-/* process_points()
- * process 2 GPoints (p1, p2)
- * add necessary edges to edge vector (edges)
+/* push_edge()
+ * add the edge between 2 device space GPoints (p1, p2) to (edges), unless it covers no rows:
+ * clipping can leave pieces shorter than a row, and an empty edge in the sorted list would
+ * end the scan of the active edges early
  */
-inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int width, int height, GMatrix ctm) {
-    GPoint oriPoints[2] = {op1, op2};
-    GPoint newPoints[2];
-
-    ctm.mapPoints(newPoints,oriPoints,2);
+inline void push_edge(std::vector<Edge>* edges, GPoint p1, GPoint p2, GPoint p1_ori, GPoint p2_ori) {
+    Edge e = make_edge(p1, p2, p1_ori, p2_ori);
+    if (e.top < e.bottom) {
+        edges->push_back(e);
+    }
+}
 
-    GPoint p1 = newPoints[0];
-    GPoint p2 = newPoints[1];
+/* process_line()
+ * process 2 device space GPoints (p1, p2)
+ * add necessary edges to edge vector (edges)
+ */
+inline void process_line(std::vector<Edge>* edges, GPoint p1, GPoint p2, int width, int height) {
 
     // if edge(s) between p1 and p2 would be valid...
     if (valid_points(p1, p2, width, height)) {
@@ -172,7 +183,7 @@ inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int
 
         // edge crosses bottom border
         if (bottom.y >= height) {
-            bottom = y_intersect(top, bottom, height-1);
+            bottom = y_intersect(top, bottom, height);
         }
 
         // PROCESS HORIZONTALLY
@@ -194,8 +205,7 @@ inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int
             rIntersect.x = 0;
             rIntersect.y = right.y;
 
-            Edge this_edge = make_edge(lIntersect,rIntersect,p1,p2);
-            (*edges).push_back(this_edge);
+            push_edge(edges, lIntersect, rIntersect, p1, p2);
         }
         
         // edge completely to the right
@@ -208,9 +218,7 @@ inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int
             rIntersect.x = width;
             rIntersect.y = right.y;
 
-            Edge this_edge = make_edge(lIntersect,rIntersect,p1,p2);
-            (*edges).push_back(this_edge);
-
+            push_edge(edges, lIntersect, rIntersect, p1, p2);
         }
         
         // edge crosses both borders
@@ -227,14 +235,9 @@ inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int
             rBend.x = width;
             rBend.y = right.y;
 
-            Edge across = make_edge(lIntersect, rIntersect, p1, p2);
-            (*edges).push_back(across);
-
-            Edge lVertical = make_edge(lIntersect, lBend, p1, p2);
-            (*edges).push_back(lVertical);
-
-            Edge rVertical = make_edge(rIntersect, rBend, p1, p2);            
-            (*edges).push_back(rVertical);
+            push_edge(edges, lIntersect, rIntersect, p1, p2);
+            push_edge(edges, lIntersect, lBend, p1, p2);
+            push_edge(edges, rIntersect, rBend, p1, p2);
         }
         
         // edge crosses left border
@@ -245,111 +248,538 @@ inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int
             lBend.x = 0;
             lBend.y = left.y;
 
-            Edge vertical = make_edge(lIntersect, lBend, p1, p2);
-            (*edges).push_back(vertical);
-
-            Edge across = make_edge(lIntersect, right, p1, p2);
-            (*edges).push_back(across);
+            push_edge(edges, lIntersect, lBend, p1, p2);
+            push_edge(edges, lIntersect, right, p1, p2);
         }
         
         // edge crosses right border
         else if (right.x >= width) {
-            GPoint rIntersect = x_intersect(left, right, width - 1);
+            GPoint rIntersect = x_intersect(left, right, width);
 
             GPoint rBend;
-            rBend.x = width - 1;
+            rBend.x = width;
             rBend.y = right.y;
 
-            Edge across = make_edge(left, rIntersect, p1, p2);
-            (*edges).push_back(across);
-
-            Edge vertical = make_edge(rIntersect, rBend, p1, p2);
-            (*edges).push_back(vertical);
+            push_edge(edges, left, rIntersect, p1, p2);
+            push_edge(edges, rIntersect, rBend, p1, p2);
         }
         
         // edge completely valid
         else {
-            Edge this_edge = make_edge(left, right, p1, p2);
-            (*edges).push_back(this_edge);
+            push_edge(edges, left, right, p1, p2);
         }
         
     }
 }
 
-/* process_quad()
- * process quadratic bezier curve defined by 3 points (a, b, c)
+/* process_points()
+ * process 2 GPoints (p1, p2), mapped to the device by (ctm)
  * add necessary edges to edge vector (edges)
  */
-inline void process_quad(std::vector<Edge>* edges, GPoint a, GPoint b, GPoint c, int width, int height, GMatrix ctm) {
-    GPoint e = (a - (b + b) + c) * 0.25;
-    float mag = std::sqrt((e.x * e.x) + (e.y * e.y));
-    
-    int num_segs = int(ceil(std::sqrt(mag * 4)));
-    float dt = 1 / float(num_segs);
-    
-    GPoint src[3] = {a, b, c};
+inline void process_points(std::vector<Edge>* edges, GPoint op1, GPoint op2, int width, int height, GMatrix ctm) {
+    GPoint oriPoints[2] = {op1, op2};
+    GPoint newPoints[2];
 
-    GPoint p0 = a;
-    GPoint p1;
-    float t = dt;
-    
-    for (int i = 1; i < num_segs; i++) {
-        p1 = quadT(src, t);
-        process_points(edges, p0, p1, width, height, ctm);
+    ctm.mapPoints(newPoints,oriPoints,2);
 
-        // update state
-        p0 = p1;
-        t += dt;
+    process_line(edges, newPoints[0], newPoints[1], width, height);
+}
+
+/* ========== FLATTEN CURVES ==========
+ * Curves are flattened after being mapped to the device (mapping the control points is exact
+ * for an affine CTM), so the number of segments depends on the curve's size in pixels rather
+ * than in the path's own coordinates.
+ *
+ * Each curve is first chopped at its y extremes, so every piece is monotonic in y. A piece is
+ * then walked from its top end down with forward differencing, so its segments come out in
+ * y order (each segment still keeps the curve's direction for winding).
+ *
+ * Flattening produces "lines": line segments stored as pairs of points (start, end). Since
+ * flattening only depends on the matrix's scale/skew, lines flattened without the translation
+ * can be reused under any translation (see path_cache.h).
+ */
+
+// default max distance (pixels) between a curve and the segments that approximate it
+constexpr float kFlattenTolerance = 0.25f;
+
+// most segments a single (monotonic) piece of a curve is flattened into
+constexpr int kFlattenMaxSegments = 1 << 10;
+
+/* flatten_segments()
+ * number of segments n so an error of (error / n^2) is within (tolerance)
+ */
+inline int flatten_segments(float error, float tolerance) {
+    float n = ceil(std::sqrt(error / tolerance));
+    return std::max(1, int(std::min(float(kFlattenMaxSegments), n)));
+}
+
+/* quad_segments()
+ * chord error of n segments of quadratic (a, b, c) is |a - 2b + c| / (4 * n^2)
+ */
+inline int quad_segments(const GPoint pts[3], float tolerance) {
+    GVector d = pts[0] - pts[1] - pts[1] + pts[2];
+    return flatten_segments(d.length() / 4, tolerance);
+}
+
+/* cubic_segments()
+ * chord error of n segments of cubic (a, b, c, d) is at most
+ * 3/4 * max(|a - 2b + c|, |b - 2c + d|) / n^2
+ */
+inline int cubic_segments(const GPoint pts[4], float tolerance) {
+    GVector d0 = pts[0] - pts[1] - pts[1] + pts[2];
+    GVector d1 = pts[1] - pts[2] - pts[2] + pts[3];
+    GVector d = {std::max(std::abs(d0.x), std::abs(d1.x)), std::max(std::abs(d0.y), std::abs(d1.y))};
+    return flatten_segments(0.75f * d.length(), tolerance);
+}
+
+/* add_line()
+ * add the segment (p0 -> p1) to lines; (up) means it was walked in reverse, from p1 to p0
+ */
+inline void add_line(std::vector<GPoint>* lines, GPoint p0, GPoint p1, bool up) {
+    if (up) {
+        std::swap(p0, p1);
     }
+    lines->push_back(p0);
+    lines->push_back(p1);
+}
+
+/* flatten_mono_quad()
+ * flatten a quadratic (pts) that is monotonic in y, top to bottom
+ * q(t) = at^2 + bt + c, forward differenced with step h:
+ *      d1 = ah^2 + bh      (first difference, at t = 0)
+ *      d2 = 2ah^2          (second difference, constant)
+ */
+inline void flatten_mono_quad(std::vector<GPoint>* lines, const GPoint pts[3], float tolerance) {
+    bool up = pts[2].y < pts[0].y;
+    GPoint src[3] = {pts[0], pts[1], pts[2]};
+    if (up) {
+        std::swap(src[0], src[2]);
+    }
+
+    int n = quad_segments(src, tolerance);
+    float h = 1 / float(n);
 
-    p1 = c;
-    process_points(edges, p0, p1, width, height, ctm);
+    GVector a = src[0] - src[1] - src[1] + src[2];
+    GVector b = (src[1] - src[0]) * 2;
+
+    GVector d1 = (a * (h * h)) + (b * h);
+    GVector d2 = a * (2 * h * h);
+
+    GPoint p0 = src[0];
+    for (int i = 1; i <= n; i++) {
+        GPoint p1 = (i == n) ? src[2] : (p0 + d1);
+        d1 += d2;
+
+        add_line(lines, p0, p1, up);
+        p0 = p1;
+    }
 }
 
-/* process_cubic()
- * process cubic bezier curve defined by 4 points (a, b, c, d)
- * add necessary edges to edge vector
+/* flatten_mono_cubic()
+ * flatten a cubic (pts) that is monotonic in y, top to bottom
+ * c(t) = at^3 + bt^2 + ct + d, forward differenced with step h:
+ *      d1 = ah^3 + bh^2 + ch   (first difference, at t = 0)
+ *      d2 = 6ah^3 + 2bh^2      (second difference, at t = 0)
+ *      d3 = 6ah^3              (third difference, constant)
  */
-inline void process_cubic(std::vector<Edge>* edges, GPoint a, GPoint b, GPoint c, GPoint d, int width, int height, GMatrix ctm) {
-    GPoint e0 = a - (b + b) + c;
-    GPoint e1 = b - (c + c) + d;
-    GPoint e;
-    e.x = std::max(std::abs(e0.x), std::abs(e1.x));
-    e.y = std::max(std::abs(e0.y), std::abs(e1.y));
-    float mag = std::sqrt((e.x * e.x) + (e.y * e.y));
-    
-    int num_segs = int(ceil(std::sqrt(mag * 3)));
-    float dt = 1 / float(num_segs);
+inline void flatten_mono_cubic(std::vector<GPoint>* lines, const GPoint pts[4], float tolerance) {
+    bool up = pts[3].y < pts[0].y;
+    GPoint src[4] = {pts[0], pts[1], pts[2], pts[3]};
+    if (up) {
+        std::swap(src[0], src[3]);
+        std::swap(src[1], src[2]);
+    }
 
-    GPoint src[4] = {a, b, c, d};
+    int n = cubic_segments(src, tolerance);
+    float h = 1 / float(n);
+    float h2 = h * h;
+    float h3 = h2 * h;
 
-    GPoint p0 = a;
-    GPoint p1;
-    float t = dt;
-    
-    for (int i = 1; i < num_segs; i++) {
-        p1 = cubicT(src, t);
-        process_points(edges, p0, p1, width, height, ctm);
+    GVector a = src[3] - src[0] + (3 * (src[1] - src[2]));
+    GVector b = 3 * (src[0] - (2 * src[1]) + src[2]);
+    GVector c = 3 * (src[1] - src[0]);
+
+    GVector d1 = (a * h3) + (b * h2) + (c * h);
+    GVector d2 = (a * (6 * h3)) + (b * (2 * h2));
+    GVector d3 = a * (6 * h3);
 
-        // update state
+    GPoint p0 = src[0];
+    for (int i = 1; i <= n; i++) {
+        GPoint p1 = (i == n) ? src[3] : (p0 + d1);
+        d1 += d2;
+        d2 += d3;
+
+        add_line(lines, p0, p1, up);
         p0 = p1;
-        t += dt;
+    }
+}
+
+/* flatten_quad()
+ * flatten the quadratic bezier curve (pts), already mapped by the matrix, into lines
+ */
+inline void flatten_quad(std::vector<GPoint>* lines, const GPoint pts[3], float tolerance) {
+    // y extreme: q'(t) = 0
+    float denom = pts[0].y - (2 * pts[1].y) + pts[2].y;
+    float t = (pts[0].y - pts[1].y) / denom;
+
+    if ((denom != 0) && (t > 0) && (t < 1)) {
+        GPoint dst[5];
+        GPath::ChopQuadAt(pts, dst, t);
+
+        // the tangent at the extreme is horizontal; make sure rounding didn't break monotonicity
+        dst[1].y = dst[2].y;
+        dst[3].y = dst[2].y;
+
+        flatten_mono_quad(lines, &dst[0], tolerance);
+        flatten_mono_quad(lines, &dst[2], tolerance);
+    } else {
+        flatten_mono_quad(lines, pts, tolerance);
+    }
+}
+
+/* cubic_y_extremes()
+ * values of t in (0, 1) (ascending) where the cubic (pts) has a y extreme; returns the count
+ * c'(t) / 3 = at^2 + 2bt + c
+ *      a = D - A + 3(B - C)
+ *      b = A - 2B + C
+ *      c = B - A
+ */
+inline int cubic_y_extremes(const GPoint pts[4], float ts[2]) {
+    float a = pts[3].y - pts[0].y + (3 * (pts[1].y - pts[2].y));
+    float b = pts[0].y - (2 * pts[1].y) + pts[2].y;
+    float c = pts[1].y - pts[0].y;
+
+    float roots[2];
+    int count = 0;
+
+    // linear (a = 0)
+    if (a == 0) {
+        if (b != 0) {
+            roots[count++] = -c / (2 * b);
+        }
+    }
+
+    // quadratic: (-b +/- sqrt(b^2 - ac)) / a
+    else {
+        float det = (b * b) - (a * c);
+        if (det >= 0) {
+            float root = std::sqrt(det);
+            roots[count++] = (-b - root) / a;
+            roots[count++] = (-b + root) / a;
+        }
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if ((roots[i] > 0) && (roots[i] < 1)) {
+            ts[n++] = roots[i];
+        }
     }
 
-    p1 = d;
-    process_points(edges, p0, p1, width, height, ctm);
+    if (n == 2) {
+        if (ts[0] > ts[1]) {
+            std::swap(ts[0], ts[1]);
+        }
+        if (ts[0] == ts[1]) {
+            n = 1;
+        }
+    }
+    return n;
+}
+
+/* flatten_cubic()
+ * flatten the cubic bezier curve (pts), already mapped by the matrix, into lines
+ */
+inline void flatten_cubic(std::vector<GPoint>* lines, const GPoint pts[4], float tolerance) {
+    GPoint src[4] = {pts[0], pts[1], pts[2], pts[3]};
+
+    float ts[2];
+    int count = cubic_y_extremes(src, ts);
+
+    // chop at each extreme, flattening the piece before it
+    float prevT = 0;
+    for (int i = 0; i < count; i++) {
+        GPoint dst[7];
+        GPath::ChopCubicAt(src, dst, (ts[i] - prevT) / (1 - prevT));
+
+        // the tangent at the extreme is horizontal; make sure rounding didn't break monotonicity
+        dst[2].y = dst[3].y;
+        dst[4].y = dst[3].y;
+
+        flatten_mono_cubic(lines, &dst[0], tolerance);
+
+        std::copy(&dst[3], &dst[7], src);
+        prevT = ts[i];
+    }
+
+    flatten_mono_cubic(lines, src, tolerance);
+}
+
+/* ========== CULL CURVES ==========
+ * When a path is much bigger than the device (e.g. zoomed far in), most of its curves are
+ * off screen. A curve lies inside the hull of its control points, so from the hull alone:
+ *      entirely above or below the device: it can't cover any row, so it's dropped
+ *      entirely left or right: only its net vertical travel matters to the winding of the
+ *          pixels, so it's replaced by its chord (which process_line() clamps to the
+ *          device's left/right side, a single vertical edge)
+ * either way without flattening it.
+ */
+
+// paths whose device bounds are this many times the device's area are culled per curve
+constexpr float kCullAreaRatio = 4;
+
+/* cull_wanted()
+ * whether the path's device bounds (dev) are much bigger than the device
+ */
+inline bool cull_wanted(const GRect& dev, int width, int height) {
+    return (dev.width() * dev.height()) > (kCullAreaRatio * float(width) * float(height));
+}
+
+/* cull_curve()
+ * handle the device space curve (pts[count]) if its hull is outside the device;
+ * returns false if it still has to be flattened
+ */
+inline bool cull_curve(std::vector<GPoint>* lines, const GPoint pts[], int count, int width, int height) {
+    float minX = pts[0].x, maxX = pts[0].x;
+    float minY = pts[0].y, maxY = pts[0].y;
+    for (int i = 1; i < count; i++) {
+        minX = std::min(minX, pts[i].x);
+        maxX = std::max(maxX, pts[i].x);
+        minY = std::min(minY, pts[i].y);
+        maxY = std::max(maxY, pts[i].y);
+    }
+
+    // above or below
+    if ((maxY < 0) || (minY >= float(height))) {
+        return true;
+    }
+
+    // left or right: the chord, clamped to the side
+    if ((maxX < 0) || (minX >= float(width))) {
+        add_line(lines, pts[0], pts[count - 1], false);
+        return true;
+    }
+
+    return false;
+}
+
+/* flatten_path()
+ * map the path by (matrix) and flatten it into lines, curves to within (tolerance) pixels
+ * if (cull) is set, matrix maps to the device (width x height), and off screen curves are
+ * culled without being flattened (see cull_curve())
+ * returns whether the path had any curves
+ */
+inline bool flatten_path(std::vector<GPoint>* lines, const GPath& path, const GMatrix& matrix, float tolerance = kFlattenTolerance,
+                         bool cull = false, int width = 0, int height = 0) {
+    bool curves = false;
+
+    GPath::SegmentIter iter(path);
+    GPath::Segment segs[GPath::kSegmentBatch];
+
+    while (int n = iter.next(segs, GPath::kSegmentBatch)) {
+        for (int i = 0; i < n; i++) {
+            GPoint* pts = segs[i].pts;
+
+            switch (segs[i].verb) {
+
+                // line
+                case GPathVerb::kLine:
+                    matrix.mapPoints(pts, 2);
+                    add_line(lines, pts[0], pts[1], false);
+                    break;
+
+                // quadratic bezier
+                case GPathVerb::kQuad:
+                    matrix.mapPoints(pts, 3);
+                    if (!cull || !cull_curve(lines, pts, 3, width, height)) {
+                        flatten_quad(lines, pts, tolerance);
+                    }
+                    curves = true;
+                    break;
+
+                // cubic bezier
+                case GPathVerb::kCubic:
+                    matrix.mapPoints(pts, 4);
+                    if (!cull || !cull_curve(lines, pts, 4, width, height)) {
+                        flatten_cubic(lines, pts, tolerance);
+                    }
+                    curves = true;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    return curves;
+}
+
+/* ========== LEVEL OF DETAIL ==========
+ * A path with many more points than pixels it covers (e.g. a detailed outline drawn zoomed
+ * out) is mostly made of sub-pixel segments. Those runs are simplified (Douglas-Peucker)
+ * before any edges are built, to within kLODTolerance pixels.
+ *
+ * The simplification is done in the path's own coordinates, for a "scale bucket" (a power of
+ * 2 at least the matrix's scale), so it can be reused for every scale in the bucket.
+ */
+
+// max distance (pixels) between a simplified path and its flattened lines
+constexpr float kLODTolerance = 0.5f;
+
+// paths with fewer points than this are never simplified
+constexpr size_t kLODMinPoints = 64;
+
+/* matrix_scale()
+ * upper bound on how much the matrix's scale/skew stretches any vector (Frobenius norm)
+ */
+inline float matrix_scale(const GMatrix& m) {
+    return std::sqrt((m[0] * m[0]) + (m[1] * m[1]) + (m[2] * m[2]) + (m[3] * m[3]));
+}
+
+/* lod_bucket()
+ * scale bucket (e) of the matrix: its scale is below 2^e
+ */
+inline int lod_bucket(const GMatrix& m) {
+    int e;
+    frexp(matrix_scale(m), &e);
+    return e;
+}
+
+/* lod_wanted()
+ * whether the path has more points than it has pixels across on the device (dev)
+ */
+inline bool lod_wanted(const GPath& path, const GRect& dev) {
+    size_t count = path.countPoints();
+    return (count >= kLODMinPoints) && (float(count) > (dev.width() + dev.height()));
+}
+
+/* segment_distance()
+ * distance from p to the segment (a, b)
+ */
+inline float segment_distance(GPoint p, GPoint a, GPoint b) {
+    GVector ab = b - a;
+    GVector ap = p - a;
+    float len2 = (ab.x * ab.x) + (ab.y * ab.y);
+
+    float t = 0;
+    if (len2 > 0) {
+        t = std::max(0.0f, std::min(1.0f, ((ap.x * ab.x) + (ap.y * ab.y)) / len2));
+    }
+    return (ap - (ab * t)).length();
+}
+
+/* simplify_polyline()
+ * Douglas-Peucker: keep the end points, and recursively the point farthest from the chord
+ * between kept points while it's more than (tolerance) away. Appends the kept points' lines.
+ */
+inline void simplify_polyline(const std::vector<GPoint>& poly, float tolerance, std::vector<GPoint>* lines) {
+    int n = int(poly.size());
+    std::vector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+
+    std::vector<std::pair<int, int>> stack = {{0, n - 1}};
+    while (!stack.empty()) {
+        auto [first, last] = stack.back();
+        stack.pop_back();
+
+        float farthest = 0;
+        int index = -1;
+        for (int i = first + 1; i < last; i++) {
+            float d = segment_distance(poly[i], poly[first], poly[last]);
+            if (d > farthest) {
+                farthest = d;
+                index = i;
+            }
+        }
+
+        if (farthest > tolerance) {
+            keep[index] = true;
+            stack.push_back({first, index});
+            stack.push_back({index, last});
+        }
+    }
+
+    int prev = 0;
+    for (int i = 1; i < n; i++) {
+        if (keep[i]) {
+            add_line(lines, poly[prev], poly[i], false);
+            prev = i;
+        }
+    }
+}
+
+/* simplify_lines()
+ * simplify each chain of connected lines (from flatten_path()) to within (tolerance).
+ * Lines of a chain either continue forward (next start == this end) or, for pieces of curves
+ * walked bottom up, backward (next end == this start).
+ */
+inline void simplify_lines(std::vector<GPoint>* lines, float tolerance) {
+    std::vector<GPoint> src;
+    src.swap(*lines);
+
+    std::vector<GPoint> poly;
+    size_t i = 0;
+    while (i + 1 < src.size()) {
+        poly.assign({src[i], src[i + 1]});
+        i += 2;
+
+        // grow the chain while lines connect in one direction
+        bool forward = (i + 1 < src.size()) && (src[i] == poly.back());
+        bool backward = !forward && (i + 1 < src.size()) && (src[i + 1] == poly.front());
+        if (backward) {
+            std::reverse(poly.begin(), poly.end());
+        }
+        while (i + 1 < src.size()) {
+            if (forward && (src[i] == poly.back())) {
+                poly.push_back(src[i + 1]);
+            } else if (backward && (src[i + 1] == poly.back())) {
+                poly.push_back(src[i]);
+            } else {
+                break;
+            }
+            i += 2;
+        }
+        if (backward) {
+            std::reverse(poly.begin(), poly.end());
+        }
+
+        simplify_polyline(poly, tolerance, lines);
+    }
 }
 
 /* ========== PROCESS EDGES ========== */
 
-/* edge_sort() */
+/* edge_sort()
+ * by top, then by x at the top row; strictly "less than", as std::sort requires
+ */
 inline bool edge_sort(const Edge& e1, const Edge& e2) {
     if (e1.top == e2.top) {
-        return e1.eval_x(float(e1.top + 0.5)) <= e2.eval_x(float(e2.top + 0.5));
+        return e1.eval_x(float(e1.top + 0.5)) < e2.eval_x(float(e2.top + 0.5));
     }
     return e1.top < e2.top;
 }
 
+/* device_bounds()
+ * bounds of (bounds) once mapped by (ctm)
+ */
+inline GRect device_bounds(const GRect& bounds, const GMatrix& ctm) {
+    GPoint corners[4] = {
+        {bounds.left, bounds.top}, {bounds.right, bounds.top},
+        {bounds.right, bounds.bottom}, {bounds.left, bounds.bottom},
+    };
+    ctm.mapPoints(corners, 4);
+
+    GRect dev = GRect::LTRB(corners[0].x, corners[0].y, corners[0].x, corners[0].y);
+    for (int i = 1; i < 4; i++) {
+        dev.left = std::min(dev.left, corners[i].x);
+        dev.top = std::min(dev.top, corners[i].y);
+        dev.right = std::max(dev.right, corners[i].x);
+        dev.bottom = std::max(dev.bottom, corners[i].y);
+    }
+    return dev;
+}
+
 /* get_edges() from GPoint* */
 inline void get_edges(std::vector<Edge>* edges, const GPoint* points, int count, int width, int height, GMatrix ctm) {
 
@@ -372,38 +802,166 @@ inline void get_edges(std::vector<Edge>* edges, const GPoint* points, int count,
     std::sort((*edges).begin(),(*edges).end(),&edge_sort);
 }
 
-/* get_edges() from GPath*/
-inline void get_edges(std::vector<Edge>* edges, const GPath& path, int width, int height, GMatrix ctm) {
-    GRect bounds = path.bounds();
-    if (valid_bounds(bounds, width, height)) {
+/* get_edges() from lines
+ * lines (see flatten_path()) are moved by (offset) onto the device
+ */
+inline void get_edges(std::vector<Edge>* edges, const GPoint lines[], size_t count, GVector offset, int width, int height) {
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        process_line(edges, lines[i] + offset, lines[i + 1] + offset, width, height);
+    }
 
-        GPath::Edger e(path);
-        GPoint pts[GPath::kMaxNextPoints];
+    // sort edges
+    std::sort((*edges).begin(), (*edges).end(), &edge_sort);
+}
 
-        while (auto v = e.next(pts)) {
-            switch (v.value()) {
-                
-                // line
-                case GPathVerb::kLine:
-                    process_points(edges, pts[0], pts[1], width, height, ctm);
-                    break;
+/* get_edges() from GPath
+ * curves are flattened to within (tolerance) pixels on the device
+ */
+inline void get_edges(std::vector<Edge>* edges, const GPath& path, int width, int height, GMatrix ctm, float tolerance = kFlattenTolerance) {
+    if (valid_bounds(device_bounds(path.bounds(), ctm), width, height)) {
+        std::vector<GPoint> lines;
+        flatten_path(&lines, path, ctm, tolerance);
+        get_edges(edges, lines.data(), lines.size(), {0, 0}, width, height);
+    }
+}
 
-                // quadratic bezier
-                case GPathVerb::kQuad:
-                    process_quad(edges, pts[0], pts[1], pts[2], width, height, ctm);
-                    break;
-                
-                // cubic bezier
-                case GPathVerb::kCubic:
-                    process_cubic(edges, pts[0], pts[1], pts[2], pts[3], width, height, ctm);
-                    break;
+/* ========== SCAN ========== */
+
+/* scan_edges()
+ * the runs of nonzero winding inside sorted (see edge_sort()) edges, passed to
+ * sink.blitRow(x, y, count) (e.g. a Blitter). The active edges (the ones covering the row) are
+ * kept in their own list: going down a row drops the ones that ended and adds the ones that
+ * start. Each row then sorts where they cross it, which is all the winding needs (and doesn't
+ * care how much the edges' order changed between rows).
+ */
+template <typename Sink>
+void scan_edges(const std::vector<Edge>& edges, Sink& sink) {
+    if (edges.size() < 2) {
+        return;
+    }
+
+    // the first row is the top of the first edge; the last is the bottom of the lowest
+    int top = edges[0].top;
+    int bottom = 0;
+    for (const Edge& e : edges) {
+        bottom = std::max(bottom, e.bottom);
+    }
+
+    std::vector<Edge> active;
+    size_t nextEdge = 0;
+
+    // (x, winding) of each active edge on the row
+    std::vector<std::pair<int, int>> crossings;
+
+    for (int y = top; y < bottom; y++) {
+        float y_ray = float(y + 0.5);
+
+        // drop the edges that ended
+        size_t kept = 0;
+        for (size_t i = 0; i < active.size(); i++) {
+            if (active[i].bottom > y) {
+                active[kept++] = active[i];
             }
         }
+        active.resize(kept);
 
-        // sort edges
-        std::sort((*edges).begin(), (*edges).end(), &edge_sort);
+        // add the edges that start
+        while ((nextEdge < edges.size()) && (edges[nextEdge].top <= y)) {
+            active.push_back(edges[nextEdge++]);
+        }
+
+        crossings.clear();
+        for (const Edge& e : active) {
+            crossings.push_back({int(round(e.eval_x(y_ray))), e.w});
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // fill from where the winding leaves 0 to where it comes back
+        int w = 0;
+        int left = 0;
+        for (const auto& c : crossings) {
+            if (w == 0) {
+                left = c.first;
+            }
+            w += c.second;
+            if (w == 0) {
+                sink.blitRow(left, y, c.first - left);
+            }
+        }
     }
+}
 
+/* ========== EDGE TEMPLATES ==========
+ * A path drawn at many translations (same scale/skew) has the same edges each time, only
+ * moved. A template keeps them unclipped and unrounded (top and bottom as floats), sorted by
+ * their top: rounding is monotonic, so once moved by any translation they're still in order of
+ * their rows, and placing them is a pass over the list: no flattening, clipping or sorting.
+ *
+ * Only a translation that keeps the template's own lines (EdgeTemplate::bounds, not the path's
+ * bounds) inside the device can be placed this way (clipping changes the edges); others go
+ * through get_edges() as usual.
+ */
+
+/* EdgeTemplate */
+struct EdgeTemplate {
+    struct Line {
+        float top, bottom;
+        float m, b;
+        int w;
+    };
+    std::vector<Line> lines;
+    GRect bounds;   // of the lines' points (no translation)
+};
+
+/* make_edge_template()
+ * the template of flattened lines (pairs of points, no translation; see flatten_path())
+ */
+inline void make_edge_template(EdgeTemplate* tmpl, const GPoint lines[], size_t count) {
+    tmpl->lines.clear();
+    tmpl->bounds = {0, 0, 0, 0};
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        GPoint p1 = lines[i];
+        GPoint p2 = lines[i + 1];
+
+        GRect& r = tmpl->bounds;
+        if (i == 0) {
+            r = GRect::LTRB(p1.x, p1.y, p1.x, p1.y);
+        }
+        r = GRect::LTRB(std::min({r.left, p1.x, p2.x}), std::min({r.top, p1.y, p2.y}),
+                        std::max({r.right, p1.x, p2.x}), std::max({r.bottom, p1.y, p2.y}));
+
+        if (p1.y == p2.y) {
+            continue;
+        }
+
+        // (as make_edge(), from the top point)
+        GPoint top = (p1.y < p2.y) ? p1 : p2;
+        GPoint bottom = (p1.y < p2.y) ? p2 : p1;
+        float m = (top.x - bottom.x) / (top.y - bottom.y);
+        tmpl->lines.push_back({top.y, bottom.y, m, top.x - (m * top.y), (p1.y < p2.y) ? -1 : 1});
+    }
+
+    std::stable_sort(tmpl->lines.begin(), tmpl->lines.end(), [](const EdgeTemplate::Line& a, const EdgeTemplate::Line& b) {
+        return a.top < b.top;
+    });
+}
+
+/* place_edges()
+ * the template's edges moved by (offset), which must keep its bounds on the device (nothing is
+ * clipped); they come out sorted by top (but not by x: the scanners don't need it)
+ */
+inline void place_edges(std::vector<Edge>* edges, const EdgeTemplate& tmpl, GVector offset) {
+    for (const EdgeTemplate::Line& line : tmpl.lines) {
+        Edge e;
+        e.top = int(round(line.top + offset.y));
+        e.bottom = int(round(line.bottom + offset.y));
+        if (e.top < e.bottom) {
+            e.m = line.m;
+            e.b = line.b + offset.x - (line.m * offset.y);
+            e.w = line.w;
+            edges->push_back(e);
+        }
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
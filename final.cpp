@@ -1,6 +1,9 @@
 #include "final.h"
 #include "veronoi_shader.h"
 #include "linear_pos_gradient.h"
+#include "stroke.h"
+
+#include <vector>
 
 /* Veronoi Shader */
 std::shared_ptr<GShader> Final::createVoronoiShader(const GPoint points[], const GColor colors[], int count) {
@@ -12,6 +15,22 @@ std::shared_ptr<GShader> Final::createLinearPosGradient(GPoint p0, GPoint p1, co
     return std::shared_ptr<GShader>(new LinearPosGradient(p0, p1, colors, pos, count));
 }
 
+/* Stroke Polygon
+ * the stroke's outline (see stroke.h), as a path to fill
+ */
+std::shared_ptr<GPath> Final::strokePolygon(const GPoint pts[], int count, float width, bool isClosed) {
+    GPathBuilder builder;
+    stroke_polyline(&builder, pts, count, width, isClosed);
+    return builder.detach();
+}
+
+/* Quadratic Coons Patch
+ * drawn by the canvas, which resolves kAutoLevel with its CTM
+ */
+void Final::drawQuadraticCoons(GCanvas* canvas, const GPoint pts[8], const GPoint tex[4], int level, const GPaint& paint) {
+    canvas->drawQuadraticCoons(pts, tex, level, paint);
+}
+
 /* GCreateFinal() */
 std::unique_ptr<GFinal> GCreateFinal() {
     return std::unique_ptr<GFinal>(new Final());
@@ -11,6 +11,10 @@ public:
     std::shared_ptr<GShader> createVoronoiShader(const GPoint points[], const GColor colors[], int count) override;
 
     std::shared_ptr<GShader> createLinearPosGradient(GPoint p0, GPoint p1, const GColor colors[], const float pos[], int count) override;
+
+    std::shared_ptr<GPath> strokePolygon(const GPoint pts[], int count, float width, bool isClosed) override;
+
+    void drawQuadraticCoons(GCanvas* canvas, const GPoint pts[8], const GPoint tex[4], int level, const GPaint& paint) override;
 };
 
 #endif
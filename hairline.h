@@ -0,0 +1,193 @@
+#ifndef HAIRLINE_DEFINED
+#define HAIRLINE_DEFINED
+
+#include "blitter.h"
+#include "include/GPoint.h"
+
+#include <cmath>
+#include <algorithm>
+
+/* ========== HAIRLINES ==========
+ * A hairline is 1 pixel wide on the device, whatever the CTM. It's stepped along its longer
+ * ("major") axis with a DDA: one pixel per column (or row), the other coordinate advancing by
+ * the slope each step, so there are no edges, sorting or spans to build.
+ *
+ * The pixels drawn are those whose major coordinate's center is in [start, end): the end point
+ * isn't drawn, so lines that join (polylines) don't blend the shared pixel twice. Segments that
+ * step along different axes can still both reach the pixel at their joint, so a polyline also
+ * passes on the last pixel drawn (HairlineJoint) for the next segment to skip.
+ *
+ * Anti-aliased hairlines (Wu) split each step's coverage between the two pixels nearest the
+ * line on the minor axis, by how close the line is to their centers.
+ */
+
+/* HairlineJoint
+ * the last pixel the previous segment of a polyline drew (if any)
+ */
+struct HairlineJoint {
+    int x = 0;
+    int y = 0;
+    bool valid = false;
+};
+
+/* hairline_range()
+ * the pixels [first, last] along an axis whose centers are in [a0, a1) (or (a1, a0] if going
+ * down), limited to [0, size); returns false if there are none
+ */
+inline bool hairline_range(float a0, float a1, int size, int* first, int* last) {
+    // (off the device by more than a pixel is as good as any further)
+    bool down = a0 > a1;
+    a0 = std::min(std::max(a0, -1.0f), float(size) + 1);
+    a1 = std::min(std::max(a1, -1.0f), float(size) + 1);
+
+    if (!down) {
+        *first = int(ceil(a0 - 0.5f));
+        *last = int(ceil(a1 - 0.5f)) - 1;
+    } else {
+        *first = int(floor(a1 - 0.5f)) + 1;
+        *last = int(floor(a0 - 0.5f));
+    }
+    *first = std::max(*first, 0);
+    *last = std::min(*last, size - 1);
+    return *first <= *last;
+}
+
+/* hairline()
+ * draw the device space hairline from p0 to p1 through the blitter, clipped to the device
+ * (width x height); with (joint), its first pixel is skipped if the previous segment drew it,
+ * and its last pixel is recorded (aliased only)
+ */
+inline void hairline(GPoint p0, GPoint p1, int width, int height, bool antialias, Blitter& blitter,
+                     HairlineJoint* joint = nullptr) {
+    // non-finite points can't be stepped
+    if (!std::isfinite(p0.x + p0.y + p1.x + p1.y)) {
+        return;
+    }
+
+    float dx = p1.x - p0.x;
+    float dy = p1.y - p0.y;
+    bool xMajor = std::abs(dx) >= std::abs(dy);
+
+    // along the major axis (u) the line steps one pixel at a time; on the minor axis (v) it
+    // moves by the slope each step
+    float u0 = xMajor ? p0.x : p0.y;
+    float u1 = xMajor ? p1.x : p1.y;
+    float v0 = xMajor ? p0.y : p0.x;
+    float slope = xMajor ? (dy / dx) : (dx / dy);
+    int uSize = xMajor ? width : height;
+    int vSize = xMajor ? height : width;
+
+    int first, last;
+    if (!hairline_range(u0, u1, uSize, &first, &last)) {
+        return;
+    }
+
+    // limit the steps to those that land on the device on the minor axis too
+    if (slope != 0) {
+        float lo = u0 + ((-1 - v0) / slope);
+        float hi = u0 + ((float(vSize) + 1 - v0) / slope);
+        if (lo > hi) {
+            std::swap(lo, hi);
+        }
+        if ((lo > float(last) + 1) || (hi < float(first) - 1)) {
+            return;
+        }
+        if (lo > float(first)) {
+            first = int(floor(lo));
+        }
+        if (hi < float(last)) {
+            last = int(ceil(hi));
+        }
+    } else if ((v0 < -1) || (v0 > float(vSize) + 1)) {
+        return;
+    }
+    if (first > last) {
+        return;
+    }
+
+    // the line's minor coordinate at the center of step u
+    auto minorAt = [&](int u) {
+        return v0 + ((float(u) + 0.5f - u0) * slope);
+    };
+
+    // don't draw the previous segment's last pixel again; record this one's
+    if (joint && !antialias) {
+        bool ascending = u0 <= u1;
+        int start = ascending ? first : last;
+        int minor = int(floor(minorAt(start)));
+        int x = xMajor ? start : minor;
+        int y = xMajor ? minor : start;
+        if (joint->valid && (x == joint->x) && (y == joint->y)) {
+            if (ascending) {
+                first += 1;
+            } else {
+                last -= 1;
+            }
+        }
+
+        joint->valid = first <= last;
+        if (joint->valid) {
+            int end = ascending ? last : first;
+            minor = int(floor(minorAt(end)));
+            joint->x = xMajor ? end : minor;
+            joint->y = xMajor ? minor : end;
+        }
+    }
+    if (first > last) {
+        return;
+    }
+
+    float v = minorAt(first);
+
+    if (antialias) {
+        for (int u = first; u <= last; u++, v += slope) {
+            // the two pixels whose centers are around v
+            float below = v - 0.5f;
+            int p = int(floor(below));
+            unsigned cover = unsigned(round((below - float(p)) * 255));
+
+            int px[2] = {p, p + 1};
+            unsigned coverage[2] = {255 - cover, cover};
+            for (int k = 0; k < 2; k++) {
+                if ((px[k] >= 0) && (px[k] < vSize)) {
+                    if (xMajor) {
+                        blitter.blitPixel(u, px[k], coverage[k]);
+                    } else {
+                        blitter.blitPixel(px[k], u, coverage[k]);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // x-major: consecutive pixels on the same row are one run
+    if (xMajor) {
+        int runStart = first;
+        int runRow = int(floor(v));
+        for (int u = first; u <= last; u++, v += slope) {
+            int row = int(floor(v));
+            if (row != runRow) {
+                if ((runRow >= 0) && (runRow < vSize)) {
+                    blitter.blitRow(runStart, runRow, u - runStart);
+                }
+                runStart = u;
+                runRow = row;
+            }
+        }
+        if ((runRow >= 0) && (runRow < vSize)) {
+            blitter.blitRow(runStart, runRow, last + 1 - runStart);
+        }
+        return;
+    }
+
+    // y-major: one pixel per row
+    for (int u = first; u <= last; u++, v += slope) {
+        int col = int(floor(v));
+        if ((col >= 0) && (col < vSize)) {
+            blitter.blitRow(col, u, 1);
+        }
+    }
+}
+
+#endif
@@ -5,11 +5,15 @@
 #ifndef GCanvas_DEFINED
 #define GCanvas_DEFINED
 
+#include "GMask.h"
 #include "GMatrix.h"
 #include "GPaint.h"
+#include "GPath.h"
+#include "GPathBuilder.h"
 #include <string>
 
 class GBitmap;
+class GTiledBitmap;
 class GPath;
 class GPoint;
 class GRect;
@@ -18,6 +22,9 @@ class GCanvas {
 public:
     virtual ~GCanvas() {}
 
+    // pass as the "level" of drawQuad() to have the canvas choose it
+    static constexpr int kAutoLevel = -1;
+
     /**
      *  Save off a copy of the canvas state (CTM), to be later used if the balancing call to
      *  restore() is made. Calls to save/restore can be nested:
@@ -45,6 +52,13 @@ public:
      */
     virtual void concat(const GMatrix& matrix) = 0;
 
+    /**
+     *  Intersect the clip with the mask, placed as in drawMask(): later draws cover each pixel
+     *  only as much as the clip does. The clip is saved and restored with the CTM. Canvases
+     *  that can't clip ignore it, which is what the default does.
+     */
+    virtual void clipMask(const GMask& mask, float x, float y) {}
+
     /**
      *  Fill the entire canvas with the specified color, using kSrc porter-duff mode.
      */
@@ -74,6 +88,140 @@ public:
             this->drawPath(*path, paint);
         }
     }
+
+    /**
+     *  Fill view.path() as if view.matrix() were pre-concatenated with the CTM, for the geometry
+     *  only: the paint's shader still uses the CTM. Drawing one path at many positions this way
+     *  needs no new paths. The default draws a transformed copy of the path.
+     */
+    virtual void drawPathView(const GPathView& view, const GPaint& paint) {
+        this->drawPath(view.materialize(), paint);
+    }
+
+    /**
+     *  Fill the path once for each of matrices[count], as if each were pre-concatenated with
+     *  the CTM for the geometry only (see drawPathView). The default draws them one at a time.
+     */
+    virtual void drawPathInstances(const GPath& path, const GMatrix matrices[], int count,
+                                   const GPaint& paint) {
+        for (int i = 0; i < count; i++) {
+            this->drawPathView(GPathView(path, matrices[i]), paint);
+        }
+    }
+
+    /**
+     *  Fill paths[count] (null entries are skipped), in order, each by its own winding: the
+     *  same as drawing them one at a time, which is what the default does.
+     */
+    virtual void drawPaths(const GPath* const paths[], int count, const GPaint& paint) {
+        for (int i = 0; i < count; i++) {
+            if (paths[i]) {
+                this->drawPath(*paths[i], paint);
+            }
+        }
+    }
+
+    /**
+     *  Draw a hairline from p0 to p1: 1 pixel wide on the device, whatever the CTM. The pixels
+     *  drawn are the ones the line steps through along its longer axis, up to but not including
+     *  p1's, so lines that meet don't draw the shared pixel twice. If the paint is anti-aliased,
+     *  each step's coverage is split between the two pixels nearest the line.
+     */
+    virtual void drawLine(GPoint p0, GPoint p1, const GPaint& paint) {
+        const GPoint pts[2] = {p0, p1};
+        this->drawPolyline(pts, 2, paint);
+    }
+
+    /**
+     *  Draw hairlines (see drawLine) joining pts[0], pts[1], ... pts[count - 1] in order.
+     *  The default fills each segment as a quad 1 unit wide (in the canvas' coordinates).
+     */
+    virtual void drawPolyline(const GPoint pts[], int count, const GPaint& paint) {
+        for (int i = 0; i + 1 < count; i++) {
+            GVector d = pts[i + 1] - pts[i];
+            float len = d.length();
+            if (len > 0) {
+                GVector n = {-d.y * 0.5f / len, d.x * 0.5f / len};
+                const GPoint quad[4] = {pts[i] + n, pts[i + 1] + n, pts[i + 1] - n, pts[i] - n};
+                this->drawConvexPolygon(quad, 4, paint);
+            }
+        }
+    }
+
+    /**
+     *  Fill the ellipse inscribed in the rect. The default fills it as a path (see
+     *  GPathBuilder::addOval).
+     */
+    virtual void drawOval(const GRect& rect, const GPaint& paint) {
+        GPathBuilder bu;
+        bu.addOval(rect);
+        this->drawPath(*bu.detach(), paint);
+    }
+
+    void drawCircle(GPoint center, float radius, const GPaint& paint) {
+        this->drawOval(GRect::LTRB(center.x - radius, center.y - radius,
+                                   center.x + radius, center.y + radius), paint);
+    }
+
+    /**
+     *  Fill the rect with its corners rounded by quarter ellipses of radii rx, ry (limited to
+     *  half its width/height). The default fills it as a path (see GPathBuilder::addRRect).
+     */
+    virtual void drawRRect(const GRect& rect, float rx, float ry, const GPaint& paint) {
+        GPathBuilder bu;
+        bu.addRRect(rect, rx, ry);
+        this->drawPath(*bu.detach(), paint);
+    }
+
+    /**
+     *  Fill rects[count], in order. The default draws them one at a time.
+     */
+    virtual void drawRects(const GRect rects[], int count, const GPaint& paint) {
+        for (int i = 0; i < count; i++) {
+            this->drawRect(rects[i], paint);
+        }
+    }
+
+    /**
+     *  Draw a marker (size) wide centered on each of pts[count], in order: a square, or a disc
+     *  if the paint's point shape is GPointShape::kDisc. The default draws them one at a time.
+     */
+    virtual void drawPoints(const GPoint pts[], int count, float size, const GPaint& paint) {
+        float r = size / 2;
+        for (int i = 0; i < count; i++) {
+            GRect rect = GRect::LTRB(pts[i].x - r, pts[i].y - r, pts[i].x + r, pts[i].y + r);
+            if (paint.getPointShape() == GPointShape::kDisc) {
+                this->drawOval(rect, paint);
+            } else {
+                this->drawRect(rect, paint);
+            }
+        }
+    }
+
+    /**
+     *  Fill with the paint where the mask covers: the mask's pixel (i, j) is the square from
+     *  (x + i, y + j) to (x + i + 1, y + j + 1), mapped by the CTM, and each pixel is covered as
+     *  much as the mask pixel its center lands in. The default fills a rect for each run of
+     *  covered pixels, the paint's alpha scaled by their coverage.
+     */
+    virtual void drawMask(const GMask& mask, float x, float y, const GPaint& paint) {
+        for (int j = 0; j < mask.height(); j++) {
+            const uint8_t* row = mask.getAddr(0, j);
+            for (int i = 0; i < mask.width();) {
+                int end = i + 1;
+                while ((end < mask.width()) && (row[end] == row[i])) {
+                    end++;
+                }
+                if (row[i]) {
+                    GPaint covered = paint;
+                    covered.setAlpha(paint.getAlpha() * float(row[i]) / 255);
+                    this->drawRect(GRect::LTRB(x + i, y + j, x + end, y + j + 1), covered);
+                }
+                i = end;
+            }
+        }
+    }
+
     /**
      *  Draw a mesh of triangles, with optional colors and/or texture-coordinates at each vertex.
      *
@@ -124,6 +272,10 @@ public:
      *
      *  colors and/or texs can be null. The resulting triangles should be passed to drawMesh(...).
      *
+     *  If level is kAutoLevel, the canvas picks the level from the size and shape of the quad
+     *  on the device (after the CTM), so small quads are not over-tessellated and large ones
+     *  are not under-tessellated.
+     *
      *  The order to draw the triangles is as follows: (e.g. levels == 1)
      *   |0 /|2 /|
      *   | / | / |
@@ -136,6 +288,14 @@ public:
     virtual void drawQuad(const GPoint verts[4], const GColor colors[4], const GPoint texs[4],
                           int level, const GPaint&) = 0;
 
+    /**
+     *  Draw the quadratic Coons patch described by GFinal::drawQuadraticCoons, tessellated by
+     *  "level" as drawQuad() is: if level is kAutoLevel, the canvas picks it from the patch's
+     *  size and the curvature of its sides on the device (after the CTM).
+     */
+    virtual void drawQuadraticCoons(const GPoint pts[8], const GPoint tex[4], int level,
+                                    const GPaint&) = 0;
+
     // Helpers
 
     void translate(float x, float y) {
@@ -166,6 +326,18 @@ public:
  */
 std::unique_ptr<GCanvas> GCreateCanvas(const GBitmap& bitmap);
 
+/**
+ *  If the mask is valid for drawing into, this returns a canvas that draws into it: only the
+ *  alpha of what is drawn is kept. If the mask is invalid, this returns NULL.
+ */
+std::unique_ptr<GCanvas> GCreateMaskCanvas(const GMask& mask);
+
+/**
+ *  If the tiled bitmap is valid for drawing into, this returns a canvas that draws into it,
+ *  allocating its tiles as they are drawn into. If it is invalid, this returns NULL.
+ */
+std::unique_ptr<GCanvas> GCreateTiledCanvas(const GTiledBitmap& bitmap);
+
 /**
  *  Implement this, drawing into the provided canvas, and returning the title of your artwork.
  */
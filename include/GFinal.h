@@ -148,6 +148,9 @@ public:
      *      linearly interpolating those points by (u)
      *
      *      Corners is computed by our standard "drawQuad" evaluation using the 4 corners 0,2,4,6
+     *
+     *  As with drawQuad(), level may be GCanvas::kAutoLevel to pick it from the patch's size
+     *  and the curvature of its sides on the device.
      */
     virtual void drawQuadraticCoons(GCanvas*, const GPoint pts[8], const GPoint tex[4],
                                     int level, const GPaint&) {}
@@ -0,0 +1,64 @@
+#ifndef GMask_DEFINED
+#define GMask_DEFINED
+
+#include "GTypes.h"
+#include <algorithm>
+
+/**
+ *  An alpha-only (A8) bitmap: one byte of coverage per pixel, 0 (none) to 255 (full). A quarter
+ *  the size of a GBitmap, for masks: draw into one with GCreateMaskCanvas, then use it with
+ *  GCanvas::drawMask or GCanvas::clipMask.
+ *
+ *  Copies share the same pixels.
+ */
+class GMask {
+public:
+    GMask() {}
+
+    /**
+     *  Wrap pixels owned by the caller (they must outlive the mask and its copies).
+     */
+    GMask(int w, int h, size_t rb, uint8_t* pixels)
+        : fWidth(w), fHeight(h), fRowBytes(rb), fPixels(pixels)
+    {
+        assert(fWidth >= 0);
+        assert(fHeight >= 0);
+        assert((size_t)fWidth <= fRowBytes);
+    }
+
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+    size_t rowBytes() const { return fRowBytes; }
+    uint8_t* pixels() const { return fPixels; }
+
+    uint8_t* getAddr(int x, int y) const {
+        assert(x >= 0 && x < this->width());
+        assert(y >= 0 && y < this->height());
+        return this->pixels() + x + (y * this->rowBytes());
+    }
+
+    /**
+     *  Allocate zeroed pixels for the mask, freed with the last copy of it. If rowBytes is 0, it
+     *  will be computed from w.
+     */
+    void alloc(int w, int h, size_t rowBytes = 0) {
+        w = std::max(w, 0);
+        h = std::max(h, 0);
+        rowBytes = std::max(rowBytes, (size_t)w);
+
+        fStorage.reset((uint8_t*)calloc(std::max(h * rowBytes, (size_t)1), 1), free);
+        fWidth = w;
+        fHeight = h;
+        fRowBytes = rowBytes;
+        fPixels = fStorage.get();
+    }
+
+private:
+    int      fWidth = 0;
+    int      fHeight = 0;
+    size_t   fRowBytes = 0;
+    uint8_t* fPixels = nullptr;
+    std::shared_ptr<uint8_t> fStorage;
+};
+
+#endif
@@ -10,6 +10,14 @@
 
 class GShader;
 
+/**
+ *  Shape of the markers GCanvas::drawPoints draws at each point.
+ */
+enum class GPointShape {
+    kSquare,
+    kDisc,
+};
+
 class GPaint {
 public:
     GPaint() {}
@@ -31,6 +39,27 @@ public:
     GBlendMode getBlendMode() const { return fMode; }
     GPaint&    setBlendMode(GBlendMode m) { fMode = m; return *this; }
 
+    /**
+     *  Anti-aliased drawing blends partially covered pixels by their coverage, instead of
+     *  drawing only the pixels whose centers are inside. Supported by hairlines, paths (including
+     *  drawPaths and drawPathInstances), ovals, rounded rects and disc points; other shapes
+     *  ignore it.
+     */
+    bool    isAntiAlias() const { return fAntiAlias; }
+    GPaint& setAntiAlias(bool aa) { fAntiAlias = aa; return *this; }
+
+    /**
+     *  A cached paint lets small paths drawn with it be rasterized once, then redrawn from a
+     *  cache as long as only their translation changes (icons, glyphs). Their position is
+     *  rounded to 1/16 of a pixel, so they may land up to 1/32 pixel away from where drawing
+     *  them without the cache would. Only paths owned by a shared_ptr are cached.
+     */
+    bool    isCached() const { return fCached; }
+    GPaint& setCached(bool cached) { fCached = cached; return *this; }
+
+    GPointShape getPointShape() const { return fPointShape; }
+    GPaint&     setPointShape(GPointShape shape) { fPointShape = shape; return *this; }
+
     GShader* peekShader() const { return fShader.get(); }
     std::shared_ptr<GShader> shareShader() const { return fShader; }
     GPaint&  setShader(std::shared_ptr<GShader> s) { fShader = s; return *this; }
@@ -39,6 +68,9 @@ private:
     GColor                      fColor = {0, 0, 0, 1};
     std::shared_ptr<GShader>    fShader;
     GBlendMode                  fMode = GBlendMode::kSrcOver;
+    bool                        fAntiAlias = false;
+    bool                        fCached = false;
+    GPointShape                 fPointShape = GPointShape::kSquare;
 };
 
 #endif
@@ -5,9 +5,12 @@
 #include "GPoint.h"
 #include "GRect.h"
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
-enum GPathVerb {
+enum GPathVerb : uint8_t {
     kMove,  // returns pts[0] from Iter
     kLine,  // returns pts[0]..pts[1] from Iter and Edger
     kQuad,  // returns pts[0]..pts[2] from Iter and Edger
@@ -28,13 +31,38 @@ public:
      */
     GRect bounds() const;
 
-    size_t countPoints() const { return fPts.size(); }
+    size_t countPoints() const { return fPtCount; }
+    size_t countVerbs() const { return fVbCount; }
+
+    const GPoint* points() const { return fPts; }
+    const GPathVerb* verbs() const { return fVbs; }
+
+    /**
+     *  Return true if the path is a single contour whose points (including the control points
+     *  of its curves) form a convex polygon, so it can be filled with just two edges per row.
+     *  This is computed once, the first time it's asked for (so making a path, or a view over
+     *  a file's points, doesn't read every point up front).
+     */
+    bool isConvex() const {
+        int8_t convex = fConvex.load(std::memory_order_relaxed);
+        if (convex < 0) {
+            // (threads racing here compute the same answer)
+            convex = this->computeConvexity();
+            fConvex.store(convex, std::memory_order_relaxed);
+        }
+        return convex;
+    }
 
     /**
      *  Create a new path by transforming the points in this path.
+     *  To just draw the path transformed, without mapping (or copying) its points, use a
+     *  GPathView with GCanvas::drawPathView() instead.
      */
     std::shared_ptr<GPath> transform(const GMatrix&) const;
 
+    /**
+     *  Create a new path by translating the points in this path (see transform()).
+     */
     std::shared_ptr<GPath> offset(float dx, float dy) const {
         return this->transform(GMatrix::Translate(dx, dy));
     }
@@ -96,6 +124,43 @@ public:
         int fPrevVerb;
     };
 
+    /**
+     *  One segment returned by SegmentIter: verb is kLine, kQuad or kCubic, with 2, 3 or 4 pts.
+     */
+    struct Segment {
+        GPathVerb verb;
+        GPoint    pts[kMaxNextPoints];
+    };
+
+    // suggested number of segments to ask SegmentIter::next() for at a time
+    enum {
+        kSegmentBatch = 16
+    };
+
+    /**
+     *  Walks the path like Edger (the same segments, including each contour's closing line),
+     *  but fills an array of up to count segments per call, returning how many were written
+     *  (0 when done). This skips Edger's per-segment optional for tight loops.
+     *
+     *   GPath::Segment segs[GPath::kSegmentBatch];
+     *   GPath::SegmentIter iter(path);
+     *   while (int n = iter.next(segs, GPath::kSegmentBatch)) {
+     *       for (int i = 0; i < n; ++i) { ... segs[i].verb, segs[i].pts ... }
+     *   }
+     */
+    class SegmentIter {
+    public:
+        SegmentIter(const GPath&);
+        int next(Segment segs[], int count);
+
+    private:
+        const GPoint*    fPrevMove;
+        const GPoint*    fCurrPt;
+        const GPathVerb* fCurrVb;
+        const GPathVerb* fStopVb;
+        bool fOpen;
+    };
+
     /**
      *  Given 0 < t < 1, subdivide the src[] quadratic bezier at t into two new quadratics in dst[]
      *  such that
@@ -112,19 +177,90 @@ public:
      */
     static void ChopCubicAt(const GPoint src[4], GPoint dst[7], float t);
 
-    GPath(std::vector<GPoint> pts, std::vector<GPathVerb> vbs)
-        : fPts(std::move(pts))
-        , fVbs(std::move(vbs))
+    /**
+     *  Copies the points and verbs into a single allocation, sized exactly for both.
+     */
+    GPath(const GPoint pts[], int ptCount, const GPathVerb vbs[], int vbCount);
+
+    ~GPath();
+
+    GPath(const std::vector<GPoint>& pts, const std::vector<GPathVerb>& vbs)
+        : GPath(pts.data(), (int)pts.size(), vbs.data(), (int)vbs.size())
     {}
 
+    /**
+     *  Return a path that uses points and verbs stored elsewhere (e.g. in a memory-mapped file)
+     *  without copying them; owner keeps that storage alive for as long as the path is.
+     *  If bounds is not null, it is returned by bounds() instead of computing them each time,
+     *  as long as it is finite and holds the path; otherwise the path's own bounds are used.
+     */
+    static std::shared_ptr<GPath> MakeView(const GPoint pts[], int ptCount,
+                                           const GPathVerb vbs[], int vbCount,
+                                           std::shared_ptr<const void> owner,
+                                           const GRect* bounds = nullptr);
+
 private:
     GPath(const GPath&) = delete;
     GPath& operator=(const GPath&) = delete;
 
     friend class GPathBuilder;
 
-    const std::vector<GPoint>    fPts;
-    const std::vector<GPathVerb> fVbs;
+    // a path over storage it doesn't own (see MakeView)
+    struct External;
+
+    GPath() {}
+
+    // whether the points and verbs are convex (see isConvex)
+    bool computeConvexity() const;
+
+    // points, then verbs: one block the path owns, or (External) storage it doesn't
+    const GPoint*    fPts = nullptr;
+    const GPathVerb* fVbs = nullptr;
+    int              fPtCount = 0;
+    int              fVbCount = 0;
+
+    mutable std::atomic<int8_t> fConvex{-1};    // -1 until isConvex() is first asked
+    bool fExternal = false;                     // an External
+    bool fHasBounds = false;                    // an External with precomputed bounds
+};
+
+/**
+ *  What a path made by MakeView needs besides GPath itself: kept out of GPath, so that the
+ *  (many) paths that own their points don't pay for it.
+ */
+struct GPath::External : GPath {
+    std::shared_ptr<const void> fOwner;
+    GRect                       fBounds;
+};
+
+/**
+ *  A path seen through a matrix, without mapping or copying its points. It only refers to the
+ *  path (which must outlive it) and holds the matrix, so it is cheap to make for each instance.
+ *
+ *  When drawn (GCanvas::drawPathView), the matrix is applied to the path's geometry as if it
+ *  were pre-concatenated with the CTM; the paint's shader still sees the canvas' CTM.
+ */
+class GPathView {
+public:
+    GPathView(const GPath& path, const GMatrix& matrix) : fPath(&path), fMatrix(matrix) {}
+
+    const GPath& path() const { return *fPath; }
+    const GMatrix& matrix() const { return fMatrix; }
+
+    // the same path, seen through m after this view's matrix
+    GPathView transform(const GMatrix& m) const {
+        return GPathView(*fPath, GMatrix::Concat(m, fMatrix));
+    }
+    GPathView offset(float dx, float dy) const {
+        return this->transform(GMatrix::Translate(dx, dy));
+    }
+
+    // a new path with the matrix applied to its points
+    std::shared_ptr<GPath> materialize() const { return fPath->transform(fMatrix); }
+
+private:
+    const GPath* fPath;
+    GMatrix      fMatrix;
 };
 
 #endif
@@ -69,6 +69,19 @@ public:
      */
     void addCircle(GPoint center, float radius, GPathDirection = GPathDirection::kCW);
 
+    /**
+     *  Append a new contour respecting the Direction: the ellipse inscribed in the rect
+     *  (4 cubics), starting at the middle of its right side.
+     */
+    void addOval(const GRect&, GPathDirection = GPathDirection::kCW);
+
+    /**
+     *  Append a new contour respecting the Direction: the rect with its corners rounded by
+     *  quarter ellipses of radii rx, ry (limited to half the rect's width/height). Starts at
+     *  the end of the top left corner's curve; a radius <= 0 is the plain rect.
+     */
+    void addRRect(const GRect&, float rx, float ry, GPathDirection = GPathDirection::kCW);
+
     void transform(const GMatrix&);
 
     /**
@@ -0,0 +1,95 @@
+#ifndef GTiledBitmap_DEFINED
+#define GTiledBitmap_DEFINED
+
+#include "GBitmap.h"
+#include "GTypes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+/**
+ *  A sparse bitmap for surfaces too big to allocate whole (e.g. 100k x 100k), mostly empty: its
+ *  pixels are a grid of kTileSize x kTileSize tiles, each allocated the first time it's drawn
+ *  into. A tile that hasn't been reads as the background color (see clear()). Draw into one with
+ *  GCreateTiledCanvas, then visit the tiles that were drawn into with forEachTile().
+ *
+ *  Copies share the same tiles.
+ */
+class GTiledBitmap {
+public:
+    static constexpr int kTileSize = 256;
+
+    GTiledBitmap() {}
+
+    /**
+     *  A (w x h) bitmap, every pixel the background color (none of its tiles allocated).
+     */
+    GTiledBitmap(int w, int h, GPixel background = 0);
+
+    int width() const { return fTiles ? fTiles->width : 0; }
+    int height() const { return fTiles ? fTiles->height : 0; }
+    int tilesX() const { return fTiles ? fTiles->tilesX : 0; }
+    int tilesY() const { return fTiles ? fTiles->tilesY : 0; }
+    GPixel background() const { return fTiles ? fTiles->background : 0; }
+
+    /**
+     *  The pixels of tile (tx, ty) (rows kTileSize pixels apart), or null if it hasn't been
+     *  allocated.
+     */
+    GPixel* peekTile(int tx, int ty) const;
+
+    /**
+     *  The pixels of tile (tx, ty), allocated (filled with the background color) if they weren't.
+     *  Safe to call from several threads at once.
+     */
+    GPixel* writeTile(int tx, int ty);
+
+    /**
+     *  The pixel at (x, y): the background color if its tile hasn't been allocated.
+     */
+    GPixel getPixel(int x, int y) const;
+
+    /**
+     *  Free every tile: all pixels read as (background) again.
+     */
+    void clear(GPixel background);
+
+    /**
+     *  Number of tiles allocated.
+     */
+    int tileCount() const;
+
+    /**
+     *  Call visitor(tx, ty, tile) for each allocated tile, in rows, with the tile as a bitmap
+     *  (clipped to the bitmap's size, e.g. to writeToFile() it). Tiles must not be allocated
+     *  while visiting.
+     */
+    template <typename V> void forEachTile(V&& visitor) const {
+        for (int ty = 0; ty < this->tilesY(); ty++) {
+            for (int tx = 0; tx < this->tilesX(); tx++) {
+                if (GPixel* pixels = this->peekTile(tx, ty)) {
+                    int w = std::min(kTileSize, this->width() - (tx * kTileSize));
+                    int h = std::min(kTileSize, this->height() - (ty * kTileSize));
+                    visitor(tx, ty, GBitmap(w, h, kTileSize * 4, pixels, false));
+                }
+            }
+        }
+    }
+
+private:
+    struct Tiles {
+        int width;
+        int height;
+        int tilesX;
+        int tilesY;
+        GPixel background;
+        std::unique_ptr<std::atomic<GPixel*>[]> tiles;
+        std::mutex mutex;       // held while allocating a tile
+
+        ~Tiles();
+    };
+    std::shared_ptr<Tiles> fTiles;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef LRU_CACHE_DEFINED
+#define LRU_CACHE_DEFINED
+
+#include "include/GPath.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/* CacheStats
+ * an LRUCache's hit/miss counters, and what it holds
+ */
+struct CacheStats {
+    size_t hits;
+    size_t misses;
+    size_t entries;
+    size_t bytes;
+};
+
+/* LRUCache
+ * thread safe, least recently used cache of values made from paths (see PathCache and
+ * MaskCache), within a memory budget. Key must identify the path by address (and whatever
+ * else the value depends on); Hash hashes a Key.
+ *
+ * Paths are immutable, so they're identified by address; each entry also keeps a weak
+ * reference to its path, so a path freed and a new one allocated at the same address is a
+ * miss. Paths not owned by a shared_ptr (no weak reference) can't be cached.
+ */
+template <typename Key, typename Value, typename Hash> class LRUCache {
+public:
+    /* constructor
+     * a single entry may take up to 1 / (maxEntryShare) of the budget
+     */
+    LRUCache(size_t budget, size_t maxEntryShare) : fBudget(budget), fMaxEntryShare(maxEntryShare) {}
+
+    /* find()
+     * the value for (key) of (path) in *value, if cached; counts a hit or a miss
+     */
+    bool find(const Key& key, const GPath& path, Value* value) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        auto found = fIndex.find(key);
+        if (found != fIndex.end()) {
+            auto entry = found->second;
+
+            // same address, but is it still the same path?
+            if (entry->owner.lock().get() == &path) {
+                fEntries.splice(fEntries.begin(), fEntries, entry);
+                fHits += 1;
+                *value = entry->value;
+                return true;
+            }
+            this->erase(entry);
+        }
+        fMisses += 1;
+        return false;
+    }
+
+    /* add()
+     * cache (value) for (key) of the path (owner), costing (bytes) besides the entry itself,
+     * unless too big or already there, then trim to the budget
+     */
+    void add(const Key& key, const std::weak_ptr<const GPath>& owner, Value value, size_t bytes) {
+        if (owner.expired()) {
+            return;
+        }
+        bytes += kEntryOverhead;
+
+        std::lock_guard<std::mutex> lock(fMutex);
+        // another thread may have added it meanwhile
+        if ((bytes > (fBudget / fMaxEntryShare)) || (fIndex.find(key) != fIndex.end())) {
+            return;
+        }
+
+        fEntries.push_front({key, owner, std::move(value), bytes});
+        fIndex[key] = fEntries.begin();
+        fBytes += bytes;
+        this->trim();
+    }
+
+    /* stats() */
+    CacheStats stats() const {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return {fHits, fMisses, fEntries.size(), fBytes};
+    }
+
+    /* setBudget()
+     * change the memory budget, evicting least recently used entries to fit
+     */
+    void setBudget(size_t budget) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fBudget = budget;
+        this->trim();
+    }
+
+    /* purge()
+     * drop every entry (the hit/miss counters are kept)
+     */
+    void purge() {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fIndex.clear();
+        fEntries.clear();
+        fBytes = 0;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        std::weak_ptr<const GPath> owner;
+        Value value;
+        size_t bytes;
+    };
+
+    // rough cost (bytes) of an entry besides its value's data: list + hash nodes, control blocks
+    static constexpr size_t kEntryOverhead = sizeof(Entry) + 96;
+
+    size_t fBudget;
+    size_t fMaxEntryShare;
+    size_t fBytes = 0;
+    size_t fHits = 0;
+    size_t fMisses = 0;
+
+    // most recently used first
+    std::list<Entry> fEntries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> fIndex;
+    mutable std::mutex fMutex;
+
+    /* erase() */
+    void erase(typename std::list<Entry>::iterator entry) {
+        fBytes -= entry->bytes;
+        fIndex.erase(entry->key);
+        fEntries.erase(entry);
+    }
+
+    /* trim()
+     * evict least recently used entries until within budget
+     */
+    void trim() {
+        while ((fBytes > fBudget) && !fEntries.empty()) {
+            this->erase(std::prev(fEntries.end()));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef MASK_DEFINED
+#define MASK_DEFINED
+
+#include "include/GMask.h"
+#include "include/GMatrix.h"
+#include "include/GRect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/* ========== MASKS ==========
+ * A mask (GMask) is drawn or clipped to with a matrix placing its pixels on the device. Each
+ * device pixel takes the coverage of the mask pixel its center lands in (nearest sampling), so
+ * a row of the device is sampled by stepping the inverse matrix one pixel at a time. Masks
+ * placed at whole pixels with no scale (shadows, cached coverage) are copied a row at a time.
+ */
+
+/* mask_box()
+ * the device pixels (width x height) the mask placed by (placed) may cover; returns false if
+ * there are none
+ */
+inline bool mask_box(const GMask& mask, const GMatrix& placed, int width, int height, GIRect* box) {
+    GPoint corners[4] = {
+        {0, 0}, {float(mask.width()), 0},
+        {float(mask.width()), float(mask.height())}, {0, float(mask.height())},
+    };
+    placed.mapPoints(corners, 4);
+
+    float l = corners[0].x, t = corners[0].y, r = corners[0].x, b = corners[0].y;
+    for (int i = 1; i < 4; i++) {
+        l = std::min(l, corners[i].x);
+        t = std::min(t, corners[i].y);
+        r = std::max(r, corners[i].x);
+        b = std::max(b, corners[i].y);
+    }
+    if (!std::isfinite(l + t + r + b)) {
+        return false;
+    }
+
+    // (clamped before converting: the mask may be far off the device)
+    auto clamp = [](float v, int hi) {
+        return int(std::min(std::max(v, 0.0f), float(hi)));
+    };
+    *box = GIRect::LTRB(clamp(floor(l), width), clamp(floor(t), height),
+                        clamp(ceil(r), width), clamp(ceil(b), height));
+    return !box->isEmpty();
+}
+
+/* sample_mask_row()
+ * coverage[i] = the mask's coverage of device pixel (x + i, y), (inverse) mapping the device
+ * to the mask's pixels; 0 off the mask
+ */
+inline void sample_mask_row(const GMask& mask, const GMatrix& inverse, int x, int y, int count, uint8_t coverage[]) {
+    GPoint p = inverse * GPoint{float(x) + 0.5f, float(y) + 0.5f};
+
+    // placed at whole pixels, unscaled: the row's overlap is copied
+    bool translate = (inverse[0] == 1) && (inverse[1] == 0) && (inverse[2] == 0) && (inverse[3] == 1)
+        && (inverse[4] == floor(inverse[4])) && (inverse[5] == floor(inverse[5]));
+    if (translate && (std::abs(inverse[4]) < 1e9f) && (std::abs(inverse[5]) < 1e9f)) {
+        std::memset(coverage, 0, size_t(count));
+
+        int my = int(floor(p.y));
+        int mx = int(floor(p.x));
+        if ((my < 0) || (my >= mask.height())) {
+            return;
+        }
+        int first = std::max(0, -mx);
+        int last = std::min(count, mask.width() - mx);
+        if (first < last) {
+            std::memcpy(coverage + first, mask.getAddr(mx + first, my), size_t(last - first));
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        float px = p.x + (inverse[0] * float(i));
+        float py = p.y + (inverse[1] * float(i));
+        bool inside = (px >= 0) && (py >= 0) && (px < float(mask.width())) && (py < float(mask.height()));
+        coverage[i] = inside ? *mask.getAddr(int(px), int(py)) : 0;
+    }
+}
+
+#endif
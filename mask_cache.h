@@ -0,0 +1,178 @@
+#ifndef MASK_CACHE_DEFINED
+#define MASK_CACHE_DEFINED
+
+#include "edge.h"
+#include "lru_cache.h"
+#include "path_cache.h"
+#include "include/GMatrix.h"
+#include "include/GPath.h"
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// default memory budget (bytes) of the shared mask cache
+constexpr size_t kMaskCacheBudget = 4 << 20;
+
+// largest share of the budget a single mask may take (1 / n); bigger masks aren't cached
+constexpr size_t kMaskCacheMaxEntryShare = 8;
+
+// paths bigger than this (pixels, either way on the device) aren't cached as masks
+constexpr float kMaskMaxSize = 256;
+
+// subpixel positions told apart on each axis: a mask is used for translations up to
+// 1 / (2 * kMaskSubpixel) pixel away from the one it was made for
+constexpr int kMaskSubpixel = 16;
+
+/* MaskSpan
+ * a run of pixels [x, x + count) on row y covered by a path
+ */
+struct MaskSpan {
+    int x, y, count;
+};
+
+/* MaskCache
+ * LRU cache of rasterized paths, as the runs (spans) the scanner fills, keyed by the path,
+ * the scale/skew part of the matrix it's drawn with, and the subpixel part of the translation
+ * (rounded to 1 / kMaskSubpixel). The spans are kept relative to the whole pixel part of the
+ * translation, so drawing the same small path again (icons, glyphs) with another paint or a
+ * whole pixel offset is only a replay of its spans through the blitter: no edges at all.
+ * drawPath() only uses it for paints that ask for it (GPaint::setCached()): the rounded
+ * translation can move a path by up to 1 / (2 * kMaskSubpixel) pixel.
+ *
+ * Paths are identified the way LRUCache does (address + weak reference), so only paths owned
+ * by a shared_ptr are cached.
+ */
+class MaskCache {
+public:
+    /* Mask
+     * the spans of a path, and where to put them on the device (add dx, dy)
+     */
+    struct Mask {
+        std::shared_ptr<const std::vector<MaskSpan>> spans;
+        int dx, dy;
+    };
+
+    using Stats = CacheStats;
+
+    /* constructor */
+    MaskCache(size_t budget) : fCache(budget, kMaskCacheMaxEntryShare) {}
+
+    /* Shared()
+     * process-wide cache used by drawPath() for cached paints
+     */
+    static MaskCache& Shared() {
+        static MaskCache cache(kMaskCacheBudget);
+        return cache;
+    }
+
+    /* Wanted()
+     * whether the path, (dev) on the device, should be drawn from a mask
+     */
+    static bool Wanted(const GPath& path, const GRect& dev) {
+        return (dev.width() <= kMaskMaxSize) && (dev.height() <= kMaskMaxSize)
+            && !path.weak_from_this().expired();
+    }
+
+    /* mask()
+     * the path's spans under (ctm), flattened to within (tolerance) pixels
+     */
+    Mask mask(const GPath& path, const GMatrix& ctm, float tolerance) {
+        float ix = floor(ctm[4]);
+        float iy = floor(ctm[5]);
+        int fx = std::min(int((ctm[4] - ix) * kMaskSubpixel), kMaskSubpixel - 1);
+        int fy = std::min(int((ctm[5] - iy) * kMaskSubpixel), kMaskSubpixel - 1);
+        Key key = {&path, ctm[0], ctm[1], ctm[2], ctm[3], tolerance, fx, fy};
+
+        std::shared_ptr<const std::vector<MaskSpan>> cached;
+        if (fCache.find(key, path, &cached)) {
+            return {cached, int(ix), int(iy)};
+        }
+
+        // (made without holding the cache's lock)
+        auto spans = std::make_shared<std::vector<MaskSpan>>();
+        rasterize(spans.get(), path, ctm, tolerance, fx, fy);
+        spans->shrink_to_fit();
+
+        fCache.add(key, path.weak_from_this(), spans, spans->capacity() * sizeof(MaskSpan));
+        return {spans, int(ix), int(iy)};
+    }
+
+    /* stats() */
+    Stats stats() const { return fCache.stats(); }
+
+    /* setBudget()
+     * change the memory budget, evicting least recently used entries to fit
+     */
+    void setBudget(size_t budget) { fCache.setBudget(budget); }
+
+    /* purge()
+     * drop every entry (the hit/miss counters are kept)
+     */
+    void purge() { fCache.purge(); }
+
+private:
+    // path identity + the matrix's scale/skew + tolerance + subpixel translation
+    struct Key {
+        const GPath* path;
+        float a, b, c, d;
+        float tolerance;
+        int fx, fy;
+
+        bool operator==(const Key& k) const {
+            return (path == k.path) && (a == k.a) && (b == k.b) && (c == k.c) && (d == k.d)
+                && (tolerance == k.tolerance) && (fx == k.fx) && (fy == k.fy);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h = std::hash<const GPath*>()(k.path);
+            for (float f : {k.a, k.b, k.c, k.d, k.tolerance}) {
+                h = (h * 31) + std::hash<float>()(f);
+            }
+            return (h * 31) + std::hash<int>()((k.fy * kMaskSubpixel) + k.fx);
+        }
+    };
+
+    /* SpanRecorder
+     * a sink for scan_edges() that keeps the spans, moved by (dx, dy)
+     */
+    struct SpanRecorder {
+        std::vector<MaskSpan>* spans;
+        int dx, dy;
+
+        void blitRow(int x, int y, int count) {
+            if (count > 0) {
+                spans->push_back({x + dx, y + dy, count});
+            }
+        }
+    };
+
+    LRUCache<Key, std::shared_ptr<const std::vector<MaskSpan>>, KeyHash> fCache;
+
+    /* rasterize()
+     * the spans of the path under ctm's scale/skew, at the subpixel translation (fx, fy)
+     * (the middle of its bucket): the path is scanned in a box of its own, just big enough,
+     * and the spans moved back to where the scale/skew puts them
+     */
+    static void rasterize(std::vector<MaskSpan>* spans, const GPath& path, const GMatrix& ctm, float tolerance, int fx, int fy) {
+        GMatrix linear(ctm[0], ctm[2], 0, ctm[1], ctm[3], 0);
+        GRect bounds = device_bounds(path.bounds(), linear);
+        int ox = int(floor(bounds.left)) - 1;
+        int oy = int(floor(bounds.top)) - 1;
+        int width = int(ceil(bounds.right)) - ox + 2;
+        int height = int(ceil(bounds.bottom)) - oy + 2;
+
+        GVector offset = {((float(fx) + 0.5f) / kMaskSubpixel) - float(ox), ((float(fy) + 0.5f) / kMaskSubpixel) - float(oy)};
+        auto lines = PathCache::Shared().lines(path, ctm, tolerance);
+        std::vector<Edge> edges;
+        get_edges(&edges, lines.pts.get(), lines.count, offset, width, height);
+
+        SpanRecorder recorder = {spans, ox, oy};
+        scan_edges(edges, recorder);
+    }
+};
+
+#endif
@@ -77,6 +77,86 @@ void GPathBuilder::addCircle(const GPoint center, float radius, GPathDirection d
     }
 }
 
+/* addOval() */
+void GPathBuilder::addOval(const GRect& r, GPathDirection dir) {
+    float v = 0.551915f;
+    GPoint unit[13] = { {1,0}, {1,v}, {v,1}, {0,1}, {-v,1}, {-1,v}, {-1,0}, {-1,-v}, {-v,-1}, {0,-1}, {v,-1}, {1,-v}, {1,0}};
+    GPoint pts[13];
+
+    GMatrix mx = GMatrix::Translate((r.left + r.right) / 2, (r.top + r.bottom) / 2)
+               * GMatrix::Scale(r.width() / 2, r.height() / 2);
+    mx.mapPoints(pts,unit,13);
+
+    // starting point
+    moveTo(pts[0]);
+
+    switch (dir) {
+
+        // CLOCKWISE
+        case GPathDirection::kCW:
+            for (int i = 1; i < 12; i+=3) {
+                cubicTo(pts[i], pts[i+1], pts[i+2]);
+            }
+            break;
+
+        // COUNTER-CLOCKWISE
+        case GPathDirection::kCCW:
+            for (int i = 11; i >= 0; i-= 3) {
+                cubicTo(pts[i], pts[i-1], pts[i-2]);
+            }
+            break;
+    }
+}
+
+/* addRRect()
+ * pts[] is the clockwise contour: a line then a corner (cubic) per side, starting at the end
+ * of the top left corner
+ */
+void GPathBuilder::addRRect(const GRect& r, float rx, float ry, GPathDirection dir) {
+    rx = std::min(rx, r.width() / 2);
+    ry = std::min(ry, r.height() / 2);
+    if (!(rx > 0) || !(ry > 0)) {
+        addRect(r, dir);
+        return;
+    }
+
+    // the corners' handles (see addCircle())
+    float hx = rx * (1 - 0.551915f);
+    float hy = ry * (1 - 0.551915f);
+    float L = r.left, T = r.top, R = r.right, B = r.bottom;
+    GPoint pts[17] = {
+        {L + rx, T},
+        {R - rx, T}, {R - hx, T}, {R, T + hy}, {R, T + ry},
+        {R, B - ry}, {R, B - hy}, {R - hx, B}, {R - rx, B},
+        {L + rx, B}, {L + hx, B}, {L, B - hy}, {L, B - ry},
+        {L, T + ry}, {L, T + hy}, {L + hx, T}, {L + rx, T},
+    };
+
+    // starting point
+    moveTo(pts[0]);
+
+    switch (dir) {
+
+        // CLOCKWISE
+        case GPathDirection::kCW:
+            for (int i = 1; i < 17; i += 4) {
+                lineTo(pts[i]);
+                cubicTo(pts[i+1], pts[i+2], pts[i+3]);
+            }
+            break;
+
+        // COUNTER-CLOCKWISE
+        case GPathDirection::kCCW:
+            for (int i = 16; i > 0; i -= 4) {
+                cubicTo(pts[i-1], pts[i-2], pts[i-3]);
+                if (i > 4) {
+                    lineTo(pts[i-4]);
+                }
+            }
+            break;
+    }
+}
+
 /* ========== GPath ========== */
 
 /* ChopQuadAt()
@@ -121,84 +201,180 @@ void GPath::ChopCubicAt(const GPoint src[4], GPoint dst[7], float t) {
 /* bounds() */
 GRect GPath::bounds() const {
     // no points
-    if (fPts.size() == 0) {
+    if (fPtCount == 0) {
         return {0,0,0,0};
     }
 
+    // precomputed (e.g. stored with a path blob)
+    if (fHasBounds) {
+        return static_cast<const External*>(this)->fBounds;
+    }
+
     float top, bottom, left, right;
     top = bottom = fPts[0].y;
     left = right = fPts[0].x;
 
-    GPath::Edger e(*this);
-    GPoint pts[GPath::kMaxNextPoints];
-    
-    // for all segments all segments
-    while (auto v = e.next(pts)) {
-
-        // line
-        if (v.value() == GPathVerb::kLine) {
-            // check top
-            if (pts[1].y < top) {
-                top = pts[1].y;
+    GPath::SegmentIter iter(*this);
+    GPath::Segment segs[GPath::kSegmentBatch];
+
+    // for all segments
+    while (int n = iter.next(segs, GPath::kSegmentBatch)) {
+        for (int i = 0; i < n; i++) {
+            GPathVerb v = segs[i].verb;
+            GPoint* pts = segs[i].pts;
+
+            // line
+            if (v == GPathVerb::kLine) {
+                // check top
+                if (pts[1].y < top) {
+                    top = pts[1].y;
+                }
+
+                // check bottom
+                if (pts[1].y > bottom) {
+                    bottom = pts[1].y;
+                }
+            
+                // check left
+                if (pts[1].x < left) {
+                    left = pts[1].x;
+                }
+
+                // check right
+                if (pts[1].x > right) {
+                    right = pts[1].x;
+                }
             }
 
-            // check bottom
-            if (pts[1].y > bottom) {
-                bottom = pts[1].y;
-            }
+            // bezier curve
+            else {
             
-            // check left
-            if (pts[1].x < left) {
-                left = pts[1].x;
-            }
+                GRect b;
+
+                // get bounds of curve
+                switch (v) {
+
+                    // quadratic bezier
+                    case GPathVerb::kQuad:
+                        b = quadBounds(pts);
+                        break;
+
+                    // cubic bezier
+                    case GPathVerb::kCubic:
+                        b = cubicBounds(pts);
+                        break;
+                }
+            
+                // check top
+                if (b.top < top) {
+                    top = b.top;
+                }
+
+                // check bottom
+                if (b.bottom > bottom) {
+                    bottom = b.bottom;
+                }
+
+                // check left
+                if (b.left < left) {
+                    left = b.left;
+                }
+
+                // check right
+                if (b.right > right) {
+                    right = b.right;
+                }
 
-            // check right
-            if (pts[1].x > right) {
-                right = pts[1].x;
             }
         }
+    }
+    
+    return GRect::LTRB(left,top,right,bottom);
+}
 
-        // bezier curve
-        else {
-            
-            GRect b;
+/* convex_turn()
+ * whether going from direction (a) to direction (b) keeps turning the same way as (turn)
+ * (the sign of the turns so far, 0 if none yet), updating it; going straight on is fine,
+ * doubling back isn't
+ */
+static bool convex_turn(GVector a, GVector b, int* turn) {
+    float cross = (a.x * b.y) - (a.y * b.x);
+
+    // straight on or back
+    if (cross == 0) {
+        return ((a.x * b.x) + (a.y * b.y)) > 0;
+    }
+
+    int sign = (cross > 0) ? 1 : -1;
+    if (*turn == 0) {
+        *turn = sign;
+    }
+    return sign == *turn;
+}
 
-            // get bounds of curve
-            switch (v.value()) {
+/* computeConvexity()
+ * convex: a single contour whose points, as a closed polygon, always turn the same way and
+ * change between going up and going down at most twice (a star turns the same way too, but
+ * goes around more than once). Curves lie inside their control points, and a curve whose
+ * control points are convex is convex itself, so checking the points covers them.
+ */
+bool GPath::computeConvexity() const {
+    // a single contour, with at least a triangle
+    if ((fVbCount < 2) || (fVbs[0] != kMove) || (fPtCount < 3)) {
+        return false;
+    }
+    for (int i = 1; i < fVbCount; i++) {
+        if (fVbs[i] == kMove) {
+            return false;
+        }
+    }
 
-                // quadratic bezier
-                case GPathVerb::kQuad:
-                    b = quadBounds(pts);
-                    break;
+    GVector first = {0, 0};
+    GVector prev = {0, 0};
+    bool started = false;
 
-                // cubic bezier
-                case GPathVerb::kCubic:
-                    b = cubicBounds(pts);
-                    break;
-            }
-            
-            // check top
-            if (b.top < top) {
-                top = b.top;
-            }
+    int turn = 0;
+    int firstDy = 0;
+    int lastDy = 0;
+    int flips = 0;
 
-            // check bottom
-            if (b.bottom > bottom) {
-                bottom = b.bottom;
-            }
+    // each side, including the closing one
+    for (int i = 0; i < fPtCount; i++) {
+        GVector v = fPts[(i + 1) % fPtCount] - fPts[i];
 
-            // check left
-            if (b.left < left) {
-                left = b.left;
-            }
+        // repeated point
+        if ((v.x == 0) && (v.y == 0)) {
+            continue;
+        }
 
-            // check right
-            if (b.right > right) {
-                right = b.right;
-            }
+        if (!started) {
+            first = v;
+            started = true;
+        } else if (!convex_turn(prev, v, &turn)) {
+            return false;
+        }
 
+        int dy = (v.y > 0) - (v.y < 0);
+        if (dy != 0) {
+            if (firstDy == 0) {
+                firstDy = dy;
+            } else if (dy != lastDy) {
+                flips += 1;
+            }
+            lastDy = dy;
         }
+
+        prev = v;
     }
-    
-    return GRect::LTRB(left,top,right,bottom);
+
+    // from the last side back to the first
+    if (!started || !convex_turn(prev, first, &turn)) {
+        return false;
+    }
+    if (lastDy != firstDy) {
+        flips += 1;
+    }
+
+    // (turn == 0: all on one line, no area)
+    return (turn != 0) && (flips <= 2);
 }
@@ -0,0 +1,262 @@
+#include "path_blob.h"
+#include "edge.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+    #include <fstream>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static const char gPathBlobMagic[4] = {'G', 'P', 'T', 'H'};
+
+/* align8() */
+static size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+/* fits()
+ * whether (count) items of (size) bytes at (offset) stay inside a blob of (total) bytes
+ */
+static bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t total) {
+    return (offset <= total) && (count <= ((total - offset) / size));
+}
+
+/* ========== READ ========== */
+
+/* constructor */
+PathBlob::PathBlob(std::shared_ptr<const void> data, size_t size)
+    : fData(std::move(data)), fSize(size), fHeader(static_cast<const PathBlobHeader*>(fData.get())) {}
+
+/* record() */
+const PathBlobRecord& PathBlob::record(int index) const {
+    const PathBlobRecord* records = reinterpret_cast<const PathBlobRecord*>(bytes() + sizeof(PathBlobHeader));
+    return records[index];
+}
+
+/* validate() */
+bool PathBlob::validate() const {
+    if (fSize < sizeof(PathBlobHeader)) {
+        return false;
+    }
+    if ((memcmp(fHeader->magic, gPathBlobMagic, 4) != 0) || (fHeader->version != kPathBlobVersion)) {
+        return false;
+    }
+    if ((fHeader->size != fSize) || !fits(sizeof(PathBlobHeader), fHeader->pathCount, sizeof(PathBlobRecord), fSize)) {
+        return false;
+    }
+
+    // points each verb adds (the move's point, or the segment's points after its start)
+    const uint64_t ptsPerVerb[] = { 1, 1, 2, 3 };
+
+    for (uint32_t i = 0; i < fHeader->pathCount; i++) {
+        const PathBlobRecord& r = record(int(i));
+
+        if (!fits(r.points, r.pointCount, sizeof(GPoint), fSize) || ((r.points % alignof(GPoint)) != 0)) {
+            return false;
+        }
+        if (!fits(r.verbs, r.verbCount, sizeof(GPathVerb), fSize)) {
+            return false;
+        }
+
+        // the verbs must use exactly the path's points, starting with a move
+        const GPathVerb* verbs = reinterpret_cast<const GPathVerb*>(bytes() + r.verbs);
+        uint64_t used = 0;
+        for (uint32_t v = 0; v < r.verbCount; v++) {
+            if ((verbs[v] > kCubic) || ((v == 0) && (verbs[v] != kMove))) {
+                return false;
+            }
+            used += ptsPerVerb[verbs[v]];
+        }
+        if (used != r.pointCount) {
+            return false;
+        }
+
+        if (r.lineCount > 0) {
+            if (!hasLines() || ((r.lineCount % 2) != 0) || ((r.lines % alignof(GPoint)) != 0)) {
+                return false;
+            }
+            if (!fits(r.lines, r.lineCount, sizeof(GPoint), fSize)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Make() */
+std::shared_ptr<PathBlob> PathBlob::Make(std::shared_ptr<const void> data, size_t size) {
+    if (!data || ((reinterpret_cast<uintptr_t>(data.get()) % 8) != 0)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<PathBlob> blob(new PathBlob(std::move(data), size));
+    if (!blob->validate()) {
+        return nullptr;
+    }
+
+    // wrap each path as a view over the blob (nothing is copied)
+    int count = int(blob->fHeader->pathCount);
+    blob->fPaths.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const PathBlobRecord& r = blob->record(i);
+        GRect bounds = GRect::LTRB(r.bounds[0], r.bounds[1], r.bounds[2], r.bounds[3]);
+
+        blob->fPaths.push_back(GPath::MakeView(
+                reinterpret_cast<const GPoint*>(blob->bytes() + r.points), int(r.pointCount),
+                reinterpret_cast<const GPathVerb*>(blob->bytes() + r.verbs), int(r.verbCount),
+                blob->fData, &bounds));
+    }
+
+    return blob;
+}
+
+/* Load() */
+std::shared_ptr<PathBlob> PathBlob::Load(const char* filename) {
+#if defined(_WIN32)
+    // no mmap: read the file into (8-byte aligned) memory instead
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return nullptr;
+    }
+    size_t size = size_t(file.tellg());
+    std::shared_ptr<uint64_t> data(new uint64_t[(size + 7) / 8], std::default_delete<uint64_t[]>());
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.get()), std::streamsize(size))) {
+        return nullptr;
+    }
+    return Make(data, size);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size <= 0)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = size_t(info.st_size);
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+
+    // unmapped once the blob and all of its paths are gone
+    std::shared_ptr<const void> data(addr, [size](const void* p) {
+        munmap(const_cast<void*>(p), size);
+    });
+    return Make(std::move(data), size);
+#endif
+}
+
+/* addToCache() */
+void PathBlob::addToCache(PathCache& cache) const {
+    if (!hasLines()) {
+        return;
+    }
+
+    for (int i = 0; i < count(); i++) {
+        const PathBlobRecord& r = record(i);
+        if (r.lineCount > 0) {
+            // share ownership of the blob, pointing at this path's lines
+            auto lines = reinterpret_cast<const GPoint*>(bytes() + r.lines);
+            PathCache::Lines view = {std::shared_ptr<const GPoint>(fData, lines), r.lineCount};
+            cache.insert(*fPaths[i], GMatrix(), fHeader->tolerance, std::move(view), 0);
+        }
+    }
+}
+
+/* ========== WRITE ========== */
+
+/* Serialize() */
+std::vector<unsigned char> PathBlob::Serialize(const std::vector<std::shared_ptr<GPath>>& paths,
+                                               float tolerance) {
+    bool withLines = (tolerance > 0);
+
+    std::vector<PathBlobRecord> records(paths.size());
+    std::vector<std::vector<GPoint>> lines(withLines ? paths.size() : 0);
+
+    // lay out each path's data after the records
+    size_t offset = sizeof(PathBlobHeader) + (paths.size() * sizeof(PathBlobRecord));
+    for (size_t i = 0; i < paths.size(); i++) {
+        const GPath& path = *paths[i];
+        PathBlobRecord& r = records[i];
+        memset(&r, 0, sizeof(r));
+
+        GRect bounds = path.bounds();
+        r.bounds[0] = bounds.left;
+        r.bounds[1] = bounds.top;
+        r.bounds[2] = bounds.right;
+        r.bounds[3] = bounds.bottom;
+
+        r.pointCount = uint32_t(path.countPoints());
+        r.points = offset;
+        offset = align8(offset + (r.pointCount * sizeof(GPoint)));
+
+        r.verbCount = uint32_t(path.countVerbs());
+        r.verbs = offset;
+        offset = align8(offset + (r.verbCount * sizeof(GPathVerb)));
+
+        if (withLines) {
+            flatten_path(&lines[i], path, GMatrix(), tolerance);
+            r.lineCount = uint32_t(lines[i].size());
+            r.lines = offset;
+            offset = align8(offset + (r.lineCount * sizeof(GPoint)));
+        }
+    }
+
+    std::vector<unsigned char> blob(offset, 0);
+
+    PathBlobHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, gPathBlobMagic, 4);
+    header.version = kPathBlobVersion;
+    header.pathCount = uint32_t(paths.size());
+    header.flags = withLines ? kPathBlobHasLines : 0;
+    header.tolerance = withLines ? tolerance : 0;
+    header.size = blob.size();
+
+    memcpy(blob.data(), &header, sizeof(header));
+    if (!records.empty()) {
+        memcpy(blob.data() + sizeof(header), records.data(), records.size() * sizeof(PathBlobRecord));
+    }
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        const PathBlobRecord& r = records[i];
+        if (r.pointCount > 0) {
+            memcpy(blob.data() + r.points, paths[i]->points(), r.pointCount * sizeof(GPoint));
+        }
+        if (r.verbCount > 0) {
+            memcpy(blob.data() + r.verbs, paths[i]->verbs(), r.verbCount * sizeof(GPathVerb));
+        }
+        if (r.lineCount > 0) {
+            memcpy(blob.data() + r.lines, lines[i].data(), r.lineCount * sizeof(GPoint));
+        }
+    }
+
+    return blob;
+}
+
+/* Write() */
+bool PathBlob::Write(const char* filename, const std::vector<std::shared_ptr<GPath>>& paths,
+                     float tolerance) {
+    std::vector<unsigned char> blob = Serialize(paths, tolerance);
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = (fwrite(blob.data(), 1, blob.size(), file) == blob.size());
+    return (fclose(file) == 0) && ok;
+}
@@ -0,0 +1,116 @@
+#ifndef PATH_BLOB_DEFINED
+#define PATH_BLOB_DEFINED
+
+#include "path_cache.h"
+#include "include/GPath.h"
+#include "include/GPoint.h"
+#include "include/GRect.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* ========== PATH BLOB FORMAT ==========
+ * A collection of paths stored so it can be memory-mapped and drawn without parsing or
+ * copying. All values are in native byte order (a file from a machine of the other byte
+ * order fails the version check); offsets are in bytes from the start of the blob.
+ *
+ *      PathBlobHeader
+ *      PathBlobRecord[pathCount]
+ *      per path: points (GPoint[pointCount]), verbs (GPathVerb[verbCount]),
+ *                lines (GPoint[lineCount], if kPathBlobHasLines), each 8-byte aligned
+ *
+ * The optional lines are the path flattened (see flatten_path()) with no scale, to
+ * (tolerance) pixels, so drawing at scale 1 can skip flattening (see PathBlob::addToCache).
+ */
+
+constexpr uint32_t kPathBlobVersion = 1;
+
+// header flags
+constexpr uint32_t kPathBlobHasLines = 1 << 0;
+
+struct PathBlobHeader {
+    char     magic[4];      // "GPTH"
+    uint32_t version;       // kPathBlobVersion
+    uint32_t pathCount;
+    uint32_t flags;
+    float    tolerance;     // of the stored lines
+    uint32_t reserved;
+    uint64_t size;          // of the whole blob
+};
+
+struct PathBlobRecord {
+    uint64_t points;
+    uint64_t verbs;
+    uint64_t lines;
+    uint32_t pointCount;
+    uint32_t verbCount;
+    uint32_t lineCount;
+    uint32_t reserved;
+    float    bounds[4];     // left, top, right, bottom
+};
+
+static_assert(sizeof(PathBlobHeader) == 32, "PathBlobHeader layout");
+static_assert(sizeof(PathBlobRecord) == 56, "PathBlobRecord layout");
+
+/* PathBlob
+ * a loaded (usually memory-mapped) path blob. Its paths are GPath views straight over the
+ * blob's points and verbs, with their stored bounds (checked against the points when loaded,
+ * see GPath::MakeView); each keeps the blob's memory alive, so they can outlive the PathBlob.
+ */
+class PathBlob {
+public:
+    /* Load()
+     * memory-map the blob in (filename); returns nullptr if it can't be read or isn't valid
+     */
+    static std::shared_ptr<PathBlob> Load(const char* filename);
+
+    /* Make()
+     * use a blob already in memory (8-byte aligned), kept alive by (data);
+     * returns nullptr if it isn't valid
+     */
+    static std::shared_ptr<PathBlob> Make(std::shared_ptr<const void> data, size_t size);
+
+    /* Serialize()
+     * the blob for (paths); if (tolerance) > 0, their flattened lines are stored too
+     */
+    static std::vector<unsigned char> Serialize(const std::vector<std::shared_ptr<GPath>>& paths,
+                                                float tolerance = 0);
+
+    /* Write()
+     * Serialize() (paths) to (filename); returns false if it can't be written
+     */
+    static bool Write(const char* filename, const std::vector<std::shared_ptr<GPath>>& paths,
+                      float tolerance = 0);
+
+    int count() const { return int(fPaths.size()); }
+
+    const std::shared_ptr<GPath>& path(int index) const { return fPaths[index]; }
+
+    bool hasLines() const { return fHeader->flags & kPathBlobHasLines; }
+
+    /* addToCache()
+     * hand the stored lines to (cache) for drawing the paths with no scale (any translation),
+     * without copying them. Each entry only counts its bookkeeping against the budget.
+     */
+    void addToCache(PathCache& cache) const;
+
+private:
+    PathBlob(std::shared_ptr<const void> data, size_t size);
+
+    /* validate()
+     * check that the header and every record stay inside the blob and describe real paths
+     */
+    bool validate() const;
+
+    const unsigned char* bytes() const { return static_cast<const unsigned char*>(fData.get()); }
+    const PathBlobRecord& record(int index) const;
+
+    std::shared_ptr<const void> fData;
+    size_t fSize;
+    const PathBlobHeader* fHeader;
+
+    std::vector<std::shared_ptr<GPath>> fPaths;
+};
+
+#endif
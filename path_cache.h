@@ -0,0 +1,188 @@
+#ifndef PATH_CACHE_DEFINED
+#define PATH_CACHE_DEFINED
+
+#include "edge.h"
+#include "include/GMatrix.h"
+#include "include/GPath.h"
+#include "include/GPoint.h"
+#include "lru_cache.h"
+
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// default memory budget (bytes) of the shared path cache
+constexpr size_t kPathCacheBudget = 4 << 20;
+
+// largest share of the budget a single path may take (1 / n); bigger paths aren't cached
+constexpr size_t kPathCacheMaxEntryShare = 8;
+
+/* PathCache
+ * LRU cache of flattened paths (lines, see flatten_path()), keyed by the path and the
+ * scale/skew part of the matrix it's drawn with. Lines are flattened without the matrix's
+ * translation, so an entry is reused whenever the same path is drawn again with only the
+ * translation changed (e.g. icons or glyphs redrawn every frame).
+ *
+ * Paths are identified the way LRUCache does (address + weak reference), so paths not owned
+ * by a shared_ptr are never cached, and neither are plain lines() of paths without curves
+ * (flattening those is just mapping their points).
+ *
+ * Simplified lines (lodLines(), see edge.h's level of detail) are kept per path per scale
+ * bucket instead, in the path's own coordinates.
+ */
+class PathCache {
+public:
+    /* Lines
+     * a view of flattened lines (pairs of points), keeping whatever stores them alive
+     */
+    struct Lines {
+        std::shared_ptr<const GPoint> pts;
+        size_t count;
+    };
+
+    using Stats = CacheStats;
+
+    /* constructor */
+    PathCache(size_t budget) : fCache(budget, kPathCacheMaxEntryShare) {}
+
+    /* Shared()
+     * process-wide cache used by drawPath()
+     */
+    static PathCache& Shared() {
+        static PathCache cache(kPathCacheBudget);
+        return cache;
+    }
+
+    /* lines()
+     * the path's lines under the scale/skew of (ctm), flattened to within (tolerance) pixels;
+     * move them by ctm's translation to put them on the device
+     */
+    Lines lines(const GPath& path, const GMatrix& ctm, float tolerance) {
+        GMatrix linear(ctm[0], ctm[2], 0, ctm[1], ctm[3], 0);
+        Key key = {&path, ctm[0], ctm[1], ctm[2], ctm[3], tolerance, 0, kNoLOD};
+
+        return this->findOrMake(path, key, [&](std::vector<GPoint>* lines) {
+            return flatten_path(lines, path, linear, tolerance);
+        });
+    }
+
+    /* lodLines()
+     * the path's lines simplified for drawing with (ctm) (see lod_bucket()), in the path's own
+     * coordinates: map them by ctm to put them on the device. Curves are flattened to within
+     * (tolerance) pixels, then the lines are simplified to within (lodTolerance) pixels.
+     */
+    Lines lodLines(const GPath& path, const GMatrix& ctm, float tolerance, float lodTolerance) {
+        int bucket = lod_bucket(ctm);
+        Key key = {&path, 0, 0, 0, 0, tolerance, lodTolerance, bucket};
+
+        // tolerances in the path's coordinates, for the largest scale in the bucket
+        float scale = ldexp(1.0f, bucket);
+        return this->findOrMake(path, key, [&](std::vector<GPoint>* lines) {
+            flatten_path(lines, path, GMatrix(), tolerance / scale);
+            simplify_lines(lines, lodTolerance / scale);
+            return true;
+        });
+    }
+
+    /* insert()
+     * add lines flattened elsewhere (e.g. stored in a path blob) for the path under the
+     * scale/skew of (ctm) and (tolerance); (bytes) is what they cost against the budget
+     */
+    void insert(const GPath& path, const GMatrix& ctm, float tolerance, Lines lines, size_t bytes) {
+        std::weak_ptr<const GPath> owner = path.weak_from_this();
+        if (owner.expired()) {
+            return;
+        }
+
+        Key key = {&path, ctm[0], ctm[1], ctm[2], ctm[3], tolerance, 0, kNoLOD};
+        fCache.add(key, owner, std::move(lines), bytes);
+    }
+
+    /* stats() */
+    Stats stats() const { return fCache.stats(); }
+
+    /* setBudget()
+     * change the memory budget, evicting least recently used entries to fit
+     */
+    void setBudget(size_t budget) { fCache.setBudget(budget); }
+
+    /* purge()
+     * drop every entry (the hit/miss counters are kept)
+     */
+    void purge() { fCache.purge(); }
+
+private:
+    // lod value of keys for (unsimplified) lines
+    static constexpr int kNoLOD = INT_MIN;
+
+    // path identity + the matrix's scale/skew + tolerance, or for simplified lines:
+    // path identity + tolerances + scale bucket (lod), the matrix left 0
+    struct Key {
+        const GPath* path;
+        float a, b, c, d;
+        float tolerance;
+        float lodTolerance;
+        int lod;
+
+        bool operator==(const Key& k) const {
+            return (path == k.path) && (a == k.a) && (b == k.b) && (c == k.c) && (d == k.d)
+                && (tolerance == k.tolerance) && (lodTolerance == k.lodTolerance) && (lod == k.lod);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h = std::hash<const GPath*>()(k.path);
+            for (float f : {k.a, k.b, k.c, k.d, k.tolerance, k.lodTolerance}) {
+                h = (h * 31) + std::hash<float>()(f);
+            }
+            return (h * 31) + std::hash<int>()(k.lod);
+        }
+    };
+
+    LRUCache<Key, Lines, KeyHash> fCache;
+
+    /* findOrMake()
+     * the cached lines for (key), or new ones from make(lines), which returns whether they're
+     * worth caching
+     */
+    template <typename Make>
+    Lines findOrMake(const GPath& path, const Key& key, Make make) {
+        std::weak_ptr<const GPath> owner = path.weak_from_this();
+
+        // not shared-owned: can't tell when it dies, so don't cache it
+        if (owner.expired()) {
+            auto lines = std::make_shared<std::vector<GPoint>>();
+            make(lines.get());
+            return view(lines);
+        }
+
+        Lines cached;
+        if (fCache.find(key, path, &cached)) {
+            return cached;
+        }
+
+        // (made without holding the cache's lock)
+        auto lines = std::make_shared<std::vector<GPoint>>();
+        bool worth = make(lines.get());
+        lines->shrink_to_fit();
+
+        if (worth) {
+            fCache.add(key, owner, view(lines), lines->capacity() * sizeof(GPoint));
+        }
+
+        return view(lines);
+    }
+
+    /* view()
+     * Lines over a vector (sharing its ownership)
+     */
+    static Lines view(const std::shared_ptr<std::vector<GPoint>>& lines) {
+        return {std::shared_ptr<const GPoint>(lines, lines->data()), lines->size()};
+    }
+
+};
+
+#endif
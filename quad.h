@@ -1,34 +1,159 @@
 #ifndef QUAD_DEFINED
 #define QUAD_DEFINED
 
-#include "canvas.h"
 #include "include/GPoint.h"
 #include "include/GColor.h"
 
-/* quadPoint() */
-GPoint quadPoint(const GPoint quadPoints[4], float u, float v) {
-    return (1-u)*(1-v)*quadPoints[0] + u*(1-v)*quadPoints[1] + (1-u)*v*quadPoints[3] + u*v*quadPoints[2];
+#include <cmath>
+#include <algorithm>
+
+/* quad_lattice()
+ * bilinearly evaluate the quad (corners: top-left, top-right, bottom-right, bottom-left)
+ * at (level + 2) x (level + 2) evenly spaced lattice points, stored row by row in lattice[].
+ *
+ * Each row's end points are evaluated directly (so the outer edges are exact), and the
+ * points between them are forward differenced: along a row the bilinear function is linear,
+ * so each point is the previous one plus a constant step.
+ */
+template <typename T>
+inline void quad_lattice(const T corners[4], int level, T lattice[]) {
+    int n = level + 1;
+    float step = 1 / float(n);
+
+    for (int v = 0; v <= n; v++) {
+        float t = (v == n) ? 1 : (v * step);
+
+        // row end points: along the left (0 -> 3) and right (1 -> 2) edges
+        T left = (corners[0] * (1 - t)) + (corners[3] * t);
+        T right = (corners[1] * (1 - t)) + (corners[2] * t);
+
+        T* row = &lattice[v * (n + 1)];
+        T delta = (right - left) * step;
+        T curr = left;
+        for (int u = 0; u < n; u++) {
+            row[u] = curr;
+            curr += delta;
+        }
+        row[n] = right;
+    }
 }
 
-/* quadColor() */
-GColor quadColor(const GColor quadColors[4], float u, float v) {
-    return (1-u)*(1-v)*quadColors[0] + u*(1-v)*quadColors[1] + (1-u)*v*quadColors[3] + u*v*quadColors[2];
+/* quad_indices()
+ * triangle indices for the quad_lattice() of level, in drawQuad() order: for each cell
+ * (row by row), the triangles 0-1-3 then 1-2-3 (split on the top-right/bottom-left diagonal)
+ */
+inline void quad_indices(int level, int indices[]) {
+    int n = level + 1;
+    int k = 0;
+
+    for (int v = 0; v < n; v++) {
+        for (int u = 0; u < n; u++) {
+            int tl = (v * (n + 1)) + u;
+            int tr = tl + 1;
+            int bl = tl + (n + 1);
+            int br = bl + 1;
+
+            indices[k++] = tl;
+            indices[k++] = tr;
+            indices[k++] = bl;
+
+            indices[k++] = tr;
+            indices[k++] = br;
+            indices[k++] = bl;
+        }
+    }
 }
 
-/* fillColorQuad() */
-void getQuadColors(const GColor quadColors[4], GColor colors[4], float u1, float u2, float v1, float v2) {
-    colors[0] = quadColor(quadColors, u1, v1);
-    colors[1] = quadColor(quadColors, u2, v1);
-    colors[2] = quadColor(quadColors, u2, v2);
-    colors[3] = quadColor(quadColors, u1, v2);
+/* ========== AUTOMATIC LEVEL ========== */
+
+// max distance (pixels) between a patch and the triangles approximating it
+constexpr float kAutoLevelTolerance = 0.5f;
+
+// longest a cell's side may be (pixels), so colors/textures are interpolated finely enough
+constexpr float kAutoLevelCellSize = 32;
+
+// fewest pixels per triangle (on average), which bounds the triangle count by the patch's area
+constexpr float kAutoLevelTrianglePixels = 8;
+
+// largest level chosen automatically
+constexpr int kAutoLevelMax = 255;
+
+/* tolerance_segments()
+ * number of segments per side so a deviation that shrinks with the square of the segment
+ * count (|d| / (4 * n^2), e.g. a quadratic's chord error or a bilinear patch's twist) stays
+ * within kAutoLevelTolerance
+ */
+inline int tolerance_segments(GVector d) {
+    return int(ceil(std::sqrt(d.length() / (4 * kAutoLevelTolerance))));
 }
 
-void getQuadPoints(const GPoint quadPoints[4], GPoint points[4], float u1, float u2, float v1, float v2) {
-    points[0] = quadPoint(quadPoints, u1, v1);
-    points[1] = quadPoint(quadPoints, u2, v1);
-    points[2] = quadPoint(quadPoints, u2, v2);
-    points[3] = quadPoint(quadPoints, u1, v2);
+/* auto_level()
+ * combine the curvature (curveSegs), size (longestSide) and area (pixels) of a patch on the
+ * device into a tessellation level
+ */
+inline int auto_level(int curveSegs, float longestSide, float area) {
+    int n = std::max(curveSegs, int(ceil(longestSide / kAutoLevelCellSize)));
+
+    // at most 2 * n^2 triangles of kAutoLevelTrianglePixels each
+    int maxN = int(std::sqrt(std::abs(area) / (2 * kAutoLevelTrianglePixels)));
+    n = std::min(n, maxN);
+
+    n = std::max(1, std::min(n, kAutoLevelMax + 1));
+    return n - 1;
+}
+
+/* polygon_area()
+ * signed area (shoelace) of the polygon pts[count]
+ */
+inline float polygon_area(const GPoint pts[], int count) {
+    float area = 0;
+    for (int i = 0; i < count; i++) {
+        GPoint p0 = pts[i];
+        GPoint p1 = pts[(i + 1) % count];
+        area += (p0.x * p1.y) - (p1.x * p0.y);
+    }
+    return area / 2;
+}
+
+/* auto_quad_level()
+ * level for a bilinear quad, given its corners on the device
+ */
+inline int auto_quad_level(const GPoint dev[4]) {
+    float longest = 0;
+    for (int i = 0; i < 4; i++) {
+        longest = std::max(longest, (dev[(i + 1) % 4] - dev[i]).length());
+    }
+
+    // twist: how far the quad is from a parallelogram (0 for affine images of a square)
+    GVector twist = dev[0] - dev[1] + dev[2] - dev[3];
+
+    return auto_level(tolerance_segments(twist), longest, polygon_area(dev, 4));
+}
+
+/* auto_coons_level()
+ * level for a coons patch of quadratic sides, given its 8 control points on the device
+ * (same layout as GFinal::drawQuadraticCoons)
+ */
+inline int auto_coons_level(const GPoint dev[8]) {
+    // sides as (start, control, end)
+    const int sides[4][3] = { {0, 1, 2}, {2, 3, 4}, {6, 5, 4}, {0, 7, 6} };
+
+    int segs = 0;
+    float longest = 0;
+    for (const auto& s : sides) {
+        GPoint a = dev[s[0]];
+        GPoint b = dev[s[1]];
+        GPoint c = dev[s[2]];
+
+        // control polygon length bounds the curve's length
+        longest = std::max(longest, (b - a).length() + (c - b).length());
+        segs = std::max(segs, tolerance_segments(a - b - b + c));
+    }
+
+    GVector twist = dev[0] - dev[2] + dev[4] - dev[6];
+    segs = std::max(segs, tolerance_segments(twist));
 
+    return auto_level(segs, longest, polygon_area(dev, 8));
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,109 @@
+#ifndef RRECT_DEFINED
+#define RRECT_DEFINED
+
+#include "blitter.h"
+#include "include/GPoint.h"
+#include "include/GRect.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* ========== ROUNDED RECTS ==========
+ * Ovals and rounded rects drawn with an axis-aligned matrix stay axis-aligned on the device,
+ * so each row's span can be solved for directly: the rect's sides, pulled in on rows that cross
+ * a corner by where the corner's ellipse crosses the row's center. There's nothing to flatten,
+ * no edges and no sorting; an oval is the rounded rect whose radii are half its size.
+ *
+ * Spans use the same sampling as the edge scanners (see edge.h): rows whose centers are inside,
+ * and the row's left/right crossings rounded to pixel boundaries.
+ */
+
+/* RRect
+ * a device space rounded rect: (rect) with corners of radii (rx, ry)
+ */
+struct RRect {
+    GRect rect;
+    float rx;
+    float ry;
+};
+
+/* rrect_make()
+ * (rect) with radii (rx, ry), mapped by the axis-aligned matrix with scale (sx, sy) and
+ * translation (tx, ty); the radii are limited to half the rect's size
+ */
+inline RRect rrect_make(const GRect& rect, float rx, float ry, float sx, float sy, float tx, float ty) {
+    float x0 = (rect.left * sx) + tx;
+    float x1 = (rect.right * sx) + tx;
+    float y0 = (rect.top * sy) + ty;
+    float y1 = (rect.bottom * sy) + ty;
+    GRect dev = GRect::LTRB(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1));
+
+    rx = std::min(std::max(rx * std::abs(sx), 0.0f), dev.width() / 2);
+    ry = std::min(std::max(ry * std::abs(sy), 0.0f), dev.height() / 2);
+    return {dev, rx, ry};
+}
+
+/* rrect_span()
+ * the left and right of the rounded rect where it crosses the horizontal line (y), which must
+ * be within the rect's top and bottom
+ */
+inline void rrect_span(const RRect& rr, float y, float* left, float* right) {
+    *left = rr.rect.left;
+    *right = rr.rect.right;
+
+    // how far into a corner's band the row is (0 at the band's inner edge, ry at the rect's)
+    float dy = std::max((rr.rect.top + rr.ry) - y, y - (rr.rect.bottom - rr.ry));
+    if ((dy > 0) && (rr.rx > 0)) {
+        float t = std::min(dy / rr.ry, 1.0f);
+        float inset = rr.rx * (1 - std::sqrt(1 - (t * t)));
+        *left += inset;
+        *right -= inset;
+    }
+}
+
+/* rrect_marker()
+ * the device space marker (see drawPoints()) centered on (p): (hx, hy) from its center to its
+ * sides, with round corners all the way in if it's a disc
+ */
+inline RRect rrect_marker(GPoint p, float hx, float hy, bool disc) {
+    GRect rect = GRect::LTRB(p.x - hx, p.y - hy, p.x + hx, p.y + hy);
+    return disc ? RRect{rect, hx, hy} : RRect{rect, 0, 0};
+}
+
+/* rrect_visible()
+ * whether any of the rect is on the device (false for non-finite rects)
+ */
+inline bool rrect_visible(const RRect& rr, int width, int height) {
+    return (rr.rect.right > 0) && (rr.rect.left < float(width))
+        && (rr.rect.bottom > 0) && (rr.rect.top < float(height));
+}
+
+/* blit_rrect()
+ * fill the rounded rect's rows in [clipTop, clipBottom), clipped to (width), through the blitter
+ */
+inline void blit_rrect(const RRect& rr, int clipTop, int clipBottom, int width, Blitter& blitter) {
+    const GRect& dev = rr.rect;
+    if (!std::isfinite(dev.left + dev.top + dev.right + dev.bottom + rr.rx + rr.ry)) {
+        return;
+    }
+
+    // (clamped before converting: the rect may be far off the device)
+    auto clamp = [](float v, int lo, int hi) {
+        return int(round(std::min(std::max(v, float(lo)), float(hi))));
+    };
+
+    // rows whose centers are inside, within the clip
+    int top = clamp(dev.top, clipTop, clipBottom);
+    int bottom = clamp(dev.bottom, clipTop, clipBottom);
+
+    for (int y = top; y < bottom; y++) {
+        float l, r;
+        rrect_span(rr, float(y) + 0.5f, &l, &r);
+
+        int left = clamp(l, 0, width);
+        int right = clamp(r, 0, width);
+        blitter.blitRow(left, y, right - left);
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef SIMD_DEFINED
+#define SIMD_DEFINED
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+/* ========== I32x4 ==========
+ * 4 lanes of int32, backed by SSE2 when available (scalar otherwise)
+ */
+struct I32x4 {
+#if defined(__SSE2__)
+    __m128i v;
+
+    I32x4() {}
+    I32x4(__m128i v) : v(v) {}
+    I32x4(int32_t x) : v(_mm_set1_epi32(x)) {}
+    I32x4(int32_t a, int32_t b, int32_t c, int32_t d) : v(_mm_setr_epi32(a, b, c, d)) {}
+
+    I32x4 operator+(I32x4 o) const { return _mm_add_epi32(v, o.v); }
+    I32x4 operator|(I32x4 o) const { return _mm_or_si128(v, o.v); }
+
+    /* signMask()
+     * bit i is set if lane i is negative
+     */
+    int signMask() const { return _mm_movemask_ps(_mm_castsi128_ps(v)); }
+#else
+    int32_t v[4];
+
+    I32x4() {}
+    I32x4(int32_t x) : v{x, x, x, x} {}
+    I32x4(int32_t a, int32_t b, int32_t c, int32_t d) : v{a, b, c, d} {}
+
+    I32x4 operator+(I32x4 o) const { return {v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3]}; }
+    I32x4 operator|(I32x4 o) const { return {v[0] | o.v[0], v[1] | o.v[1], v[2] | o.v[2], v[3] | o.v[3]}; }
+
+    int signMask() const {
+        return (v[0] < 0 ? 1 : 0) | (v[1] < 0 ? 2 : 0) | (v[2] < 0 ? 4 : 0) | (v[3] < 0 ? 8 : 0);
+    }
+#endif
+};
+
+/* ========== COVERAGE ==========
+ * Anti-aliased fills accumulate signed area per pixel (see aa.h); a row's coverage is the
+ * running sum of its cells, as a magnitude clamped to 1 (nonzero winding).
+ */
+
+/* accumulate_coverage()
+ * coverage[i] = min(|acc[0] + ... + acc[i]|, 1) * 255 (rounded), for i in [0, count); the
+ * running sum is done 4 lanes at a time (shift and add twice, then add the carry) with SSE2
+ */
+inline void accumulate_coverage(const float acc[], uint8_t coverage[], int count) {
+    int i = 0;
+    float sum = 0;
+
+#if defined(__SSE2__)
+    __m128 carry = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(acc + i);
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, carry);
+        carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // |x| clamped to 1, to 0..255: rounded by adding 0.5 and truncating, as the tail is
+        // (cvtps would round halves to even, so a pixel could differ by where it lands)
+        __m128 c = _mm_add_ps(_mm_mul_ps(_mm_min_ps(_mm_andnot_ps(sign, x), one), scale), half);
+        __m128i v = _mm_cvttps_epi32(c);
+        v = _mm_packs_epi32(v, v);
+        v = _mm_packus_epi16(v, v);
+        int32_t packed = _mm_cvtsi128_si32(v);
+        coverage[i + 0] = uint8_t(packed);
+        coverage[i + 1] = uint8_t(packed >> 8);
+        coverage[i + 2] = uint8_t(packed >> 16);
+        coverage[i + 3] = uint8_t(packed >> 24);
+    }
+    sum = _mm_cvtss_f32(carry);
+#endif
+
+    for (; i < count; i++) {
+        sum += acc[i];
+        float c = (sum < 0) ? -sum : sum;
+        coverage[i] = uint8_t(((c < 1) ? c : 1) * 255 + 0.5f);
+    }
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include "../include/GPathBuilder.h"
 #include "../include/GMatrix.h"
 
+#include <algorithm>
+#include <cmath>
+
 void GPathBuilder::reset() {
     fPts.clear();
     fVbs.clear();
@@ -41,7 +44,9 @@ void GPathBuilder::transform(const GMatrix& m) {
 }
 
 std::shared_ptr<GPath> GPathBuilder::detach() {
-    auto path = std::make_shared<GPath>(std::move(fPts), std::move(fVbs));
+    // copy (rather than move) into one exactly sized block: the builder's vectors keep their
+    // spare capacity, for the next path, instead of the path carrying it around
+    auto path = std::make_shared<GPath>(fPts.data(), (int)fPts.size(), fVbs.data(), (int)fVbs.size());
     this->reset();
     return path;
 }
@@ -53,19 +58,67 @@ static bool is_identity(const GMatrix& m) {
            m[1] == 0 && m[2] == 0 && m[4] == 0 && m[5] == 0;
 }
 
+GPath::GPath(const GPoint pts[], int ptCount, const GPathVerb vbs[], int vbCount)
+    : fPtCount(ptCount)
+    , fVbCount(vbCount)
+{
+    size_t bytes = ptCount * sizeof(GPoint) + vbCount * sizeof(GPathVerb);
+    unsigned char* storage = bytes ? new unsigned char[bytes] : nullptr;
+    GPoint* dstPts = reinterpret_cast<GPoint*>(storage);
+    GPathVerb* dstVbs = reinterpret_cast<GPathVerb*>(storage + ptCount * sizeof(GPoint));
+
+    std::copy(pts, pts + ptCount, dstPts);
+    std::copy(vbs, vbs + vbCount, dstVbs);
+    fPts = dstPts;
+    fVbs = dstVbs;
+}
+
+GPath::~GPath() {
+    // (the block starts with the points)
+    if (!fExternal) {
+        delete[] reinterpret_cast<const unsigned char*>(fPts);
+    }
+}
+
+std::shared_ptr<GPath> GPath::MakeView(const GPoint pts[], int ptCount,
+                                       const GPathVerb vbs[], int vbCount,
+                                       std::shared_ptr<const void> owner,
+                                       const GRect* bounds) {
+    auto path = std::make_shared<External>();
+    path->fPts = pts;
+    path->fVbs = vbs;
+    path->fPtCount = ptCount;
+    path->fVbCount = vbCount;
+    path->fExternal = true;
+    path->fOwner = std::move(owner);
+    if (bounds) {
+        // only trust bounds that hold the path's own (e.g. from a file): otherwise culling
+        // against them would drop what's really drawn
+        GRect actual = path->bounds();
+        bool finite = std::isfinite(bounds->left) && std::isfinite(bounds->top) &&
+                      std::isfinite(bounds->right) && std::isfinite(bounds->bottom);
+        bool holds = finite && (bounds->left <= actual.left) && (bounds->top <= actual.top) &&
+                     (bounds->right >= actual.right) && (bounds->bottom >= actual.bottom);
+        path->fBounds = holds ? *bounds : actual;
+        path->fHasBounds = true;
+    }
+    return path;
+}
+
 std::shared_ptr<GPath> GPath::transform(const GMatrix& m) const {
-    if (fPts.empty() || is_identity(m)) {
+    if (fPtCount == 0 || is_identity(m)) {
         return const_cast<GPath*>(this)->shared_from_this();
     }
-    std::vector<GPoint> dst(fPts.size());
-    m.mapPoints(dst.data(), fPts.data(), fPts.size());
-    return std::make_shared<GPath>(std::move(dst), fVbs);
+    auto dst = std::make_shared<GPath>(fPts, fPtCount, fVbs, fVbCount);
+    // dst owns a copy of the points, so it's safe to write them
+    m.mapPoints(const_cast<GPoint*>(dst->fPts), fPts, fPtCount);
+    return dst;
 }
 
 GPath::Iter::Iter(const GPath& path) {
-    fCurrPt = path.fPts.data();
-    fCurrVb = path.fVbs.data();
-    fStopVb = fCurrVb + path.fVbs.size();
+    fCurrPt = path.fPts;
+    fCurrVb = path.fVbs;
+    fStopVb = fCurrVb + path.fVbCount;
 }
 
 std::optional<GPathVerb> GPath::Iter::next(GPoint pts[]) {
@@ -101,9 +154,9 @@ constexpr int kDoneVerb = -1;
 
 GPath::Edger::Edger(const GPath& path) {
     fPrevMove = nullptr;
-    fCurrPt = path.fPts.data();
-    fCurrVb = path.fVbs.data();
-    fStopVb = fCurrVb + path.fVbs.size();
+    fCurrPt = path.fPts;
+    fCurrVb = path.fVbs;
+    fStopVb = fCurrVb + path.fVbCount;
     fPrevVerb = kDoneVerb;
 }
 
@@ -113,7 +166,7 @@ std::optional<GPathVerb> GPath::Edger::next(GPoint pts[]) {
     while (fCurrVb < fStopVb) {
         switch (*fCurrVb++) {
             case kMove:
-                if (fPrevVerb == kLine) {
+                if (fPrevVerb >= kLine && fPrevVerb <= kCubic) {
                     pts[0] = fCurrPt[-1];
                     pts[1] = *fPrevMove;
                     do_return = true;
@@ -153,3 +206,55 @@ std::optional<GPathVerb> GPath::Edger::next(GPoint pts[]) {
         return {};
     }
 }
+
+GPath::SegmentIter::SegmentIter(const GPath& path) {
+    fPrevMove = nullptr;
+    fCurrPt = path.fPts;
+    fCurrVb = path.fVbs;
+    fStopVb = fCurrVb + path.fVbCount;
+    fOpen = false;
+}
+
+int GPath::SegmentIter::next(Segment segs[], int count) {
+    assert(fCurrVb <= fStopVb);
+    // points each verb adds after the current one
+    static const int gPtsPerVerb[] = { 1, 1, 2, 3 };
+
+    int n = 0;
+    while (n < count) {
+        if (fCurrVb == fStopVb) {
+            // close the last contour
+            if (fOpen) {
+                segs[n].verb = kLine;
+                segs[n].pts[0] = fCurrPt[-1];
+                segs[n].pts[1] = *fPrevMove;
+                n += 1;
+                fOpen = false;
+            }
+            break;
+        }
+
+        GPathVerb v = *fCurrVb++;
+        if (v == kMove) {
+            // close the previous contour (a move emits nothing else, so there's room)
+            if (fOpen) {
+                segs[n].verb = kLine;
+                segs[n].pts[0] = fCurrPt[-1];
+                segs[n].pts[1] = *fPrevMove;
+                n += 1;
+                fOpen = false;
+            }
+            fPrevMove = fCurrPt++;
+            continue;
+        }
+
+        Segment& seg = segs[n++];
+        seg.verb = v;
+        seg.pts[0] = fCurrPt[-1];
+        for (int i = 1; i <= gPtsPerVerb[v]; ++i) {
+            seg.pts[i] = *fCurrPt++;
+        }
+        fOpen = true;
+    }
+    return n;
+}
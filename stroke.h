@@ -0,0 +1,206 @@
+#ifndef STROKE_DEFINED
+#define STROKE_DEFINED
+
+#include "include/GPathBuilder.h"
+#include "include/GPoint.h"
+
+#include <cmath>
+#include <vector>
+
+/* ========== STROKE ==========
+ * A stroke of a polyline is built as its outline: the left side offset by the radius walked
+ * forward, a round cap, the right side walked backward, and a round cap back to the start. That
+ * is one contour with O(n) edges (rather than a rect per segment and a circle per point), and
+ * nothing inside it is covered twice.
+ *
+ * At a join, the side on the outside of the turn gets a round arc. The side on the inside goes
+ * through the join's point (the pivot) instead of trying to intersect the offsets: the small
+ * loops this makes turn the same way as the rest of the outline, so they fill correctly under
+ * nonzero winding.
+ *
+ * Arcs are cubics (at most a quarter circle each), not lines: the stroke doesn't know the matrix
+ * it'll be drawn with, and curves are flattened to the device tolerance once they're mapped (see
+ * edge.h), so the joins and caps stay round at any scale.
+ */
+
+// below this (the sine of the angle between unit normals), a join is straight or doubles back
+constexpr float kStrokeParallel = 1e-4f;
+
+/* stroke_cross() */
+inline float stroke_cross(GVector a, GVector b) {
+    return (a.x * b.y) - (a.y * b.x);
+}
+
+/* stroke_dot() */
+inline float stroke_dot(GVector a, GVector b) {
+    return (a.x * b.x) + (a.y * b.y);
+}
+
+/* stroke_normal()
+ * unit normal to the left of the direction from p0 to p1 (which must differ)
+ */
+inline GVector stroke_normal(GPoint p0, GPoint p1) {
+    GVector d = p1 - p0;
+    float len = d.length();
+    return {d.y / len, -d.x / len};
+}
+
+/* stroke_arc()
+ * continue the contour from (center + a * radius) along the circle to (center + b * radius),
+ * turning the way of positive cross products if (dir) > 0 (else the other way), in cubics of
+ * at most 90 degrees; a and b are unit vectors
+ */
+inline void stroke_arc(GPathBuilder* builder, GPoint center, GVector a, GVector b, float radius, float dir) {
+    // angle swept from a to b in the direction of dir, in (0, 2pi]
+    float angle = atan2(stroke_cross(a, b), stroke_dot(a, b));
+    if (dir < 0) {
+        angle = -angle;
+    }
+    if (angle <= 0) {
+        angle += 2 * gFloatPI;
+    }
+
+    int count = int(ceil(angle / (gFloatPI / 2)));
+    float step = angle / float(count);
+    float s = (dir < 0) ? -step : step;
+    float c = cos(s);
+    float sn = sin(s);
+
+    // handle length for this step (0.5523 * radius for a quarter circle)
+    float handle = radius * (4.0f / 3.0f) * tan(step / 4);
+    if (dir < 0) {
+        handle = -handle;
+    }
+
+    GVector u = a;
+    for (int i = 0; i < count; i++) {
+        GVector next = (i == count - 1) ? b : GVector{(u.x * c) - (u.y * sn), (u.x * sn) + (u.y * c)};
+
+        // tangents (counter-clockwise) at both ends, scaled to the handle
+        GVector t0 = {-u.y * handle, u.x * handle};
+        GVector t1 = {-next.y * handle, next.x * handle};
+
+        GPoint p0 = center + (u * radius);
+        GPoint p3 = center + (next * radius);
+        builder->cubicTo(p0 + t0, p3 - t1, p3);
+
+        u = next;
+    }
+}
+
+/* stroke_join()
+ * continue one side of the outline around the point (pivot), from its offset (a) to (b);
+ * (in) is the direction the side arrives in
+ */
+inline void stroke_join(GPathBuilder* builder, GPoint pivot, GVector a, GVector b, GVector in, float radius) {
+    float turn = stroke_cross(a, b);
+    bool parallel = std::abs(turn) < kStrokeParallel;
+
+    // (nearly) straight on
+    if (parallel && (stroke_dot(a, b) > 0)) {
+        builder->lineTo(pivot + (b * radius));
+    }
+
+    // doubling back: both sides are rounded over the front, like a cap
+    else if (parallel) {
+        stroke_arc(builder, pivot, a, b, radius, stroke_cross(a, in));
+    }
+
+    // outside of the turn (b points ahead): round it
+    else if (stroke_dot(b, in) > 0) {
+        stroke_arc(builder, pivot, a, b, radius, turn);
+    }
+
+    // inside of the turn: through the pivot
+    else {
+        builder->lineTo(pivot);
+        builder->lineTo(pivot + (b * radius));
+    }
+}
+
+/* stroke_side()
+ * walk one side of the polyline pts[count] (count >= 2, no repeated neighbors) at the offset
+ * sign * radius to the left, from pts[0] to pts[count - 1], starting at the offset of pts[0]
+ * (already in the contour) and ending at the offset of pts[count - 1]
+ */
+inline void stroke_side(GPathBuilder* builder, const std::vector<GPoint>& pts, const std::vector<GVector>& normals,
+                        float radius, float sign, bool forward) {
+    int count = int(pts.size());
+    for (int k = 0; k < count - 1; k++) {
+        int i = forward ? k : (count - 2 - k);
+        GVector n = normals[i] * sign;
+        GPoint end = forward ? pts[i + 1] : pts[i];
+        builder->lineTo(end + (n * radius));
+
+        // join with the next segment walked
+        if (k < count - 2) {
+            int j = forward ? (i + 1) : (i - 1);
+            GVector in = forward ? (pts[i + 1] - pts[i]) : (pts[i] - pts[i + 1]);
+            stroke_join(builder, end, n, normals[j] * sign, in, radius);
+        }
+    }
+}
+
+/* stroke_polyline()
+ * add the outline of the stroke (width) of pts[count] to (builder), with round joins and caps;
+ * a closed polyline is outlined as a ring: the left side forward and the right side backward
+ */
+inline void stroke_polyline(GPathBuilder* builder, const GPoint pts[], int count, float width, bool closed) {
+    float radius = width / 2;
+    if ((count <= 0) || !(radius > 0)) {
+        return;
+    }
+
+    // drop repeated points (they have no direction)
+    std::vector<GPoint> points;
+    points.reserve(count + 2);
+    for (int i = 0; i < count; i++) {
+        if (points.empty() || (pts[i] != points.back())) {
+            points.push_back(pts[i]);
+        }
+    }
+    if (closed && (points.size() > 1) && (points.back() == points.front())) {
+        points.pop_back();
+    }
+
+    // a single point: a dot
+    if (points.size() == 1) {
+        builder->addCircle(points[0], radius);
+        return;
+    }
+
+    // a closed polyline walks back to its start
+    if (closed) {
+        points.push_back(points[0]);
+    }
+
+    std::vector<GVector> normals(points.size() - 1);
+    for (size_t i = 0; i + 1 < points.size(); i++) {
+        normals[i] = stroke_normal(points[i], points[i + 1]);
+    }
+    int last = int(normals.size()) - 1;
+
+    if (closed) {
+        GPoint start = points[0];
+
+        // left side: the join at the start (arriving along the last segment), then forward
+        builder->moveTo(start + (normals[last] * radius));
+        stroke_join(builder, start, normals[last], normals[0], start - points[last], radius);
+        stroke_side(builder, points, normals, radius, 1, true);
+
+        // right side: backward, then the join at the start (arriving along the first segment)
+        builder->moveTo(start - (normals[last] * radius));
+        stroke_side(builder, points, normals, radius, -1, false);
+        stroke_join(builder, start, -1 * normals[0], -1 * normals[last], start - points[1], radius);
+        return;
+    }
+
+    // left side, end cap, right side back, start cap
+    builder->moveTo(points[0] + (normals[0] * radius));
+    stroke_side(builder, points, normals, radius, 1, true);
+    stroke_arc(builder, points.back(), normals[last], -1 * normals[last], radius, stroke_cross(normals[last], points.back() - points[last]));
+    stroke_side(builder, points, normals, radius, -1, false);
+    stroke_arc(builder, points[0], -1 * normals[0], normals[0], radius, stroke_cross(-1 * normals[0], points[0] - points[1]));
+}
+
+#endif
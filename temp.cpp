@@ -1,27 +1,51 @@
 #include "canvas.h"
 #include "blend.h"
 #include "edge.h"
+#include "path_cache.h"
+#include "mask_cache.h"
+#include "blitter.h"
+#include "aa.h"
 
 #include <vector>
 #include <algorithm>
 #include <iostream>
 
-/* edge_sort_x() */
-bool edge_sort_x(const Edge& e1, const Edge& e2, float y) {
-    return e1.eval_x(float(y + 0.5)) <= e2.eval_x(float(y + 0.5));
-}
-
 /* drawPath() */
 void MyCanvas::drawPath(const GPath& path, const GPaint& paint) {
+    fillPath(path, matrices.top(), paint);
+}
+
+/* drawPathView()
+ * the view's matrix only moves the geometry (the shader still uses the CTM)
+ */
+void MyCanvas::drawPathView(const GPathView& view, const GPaint& paint) {
+    fillPath(view.path(), matrices.top() * view.matrix(), paint);
+}
+
+/* fillPath()
+ * fill the path, mapped to the device by (matrix)
+ */
+void MyCanvas::fillPath(const GPath& path, const GMatrix& matrix, const GPaint& paint) {
     // GBlendMode optBlendMode = get_optimized_blend(paint);
     GBlendMode optBlendMode = paint.getBlendMode();
 
     if (optBlendMode != GBlendMode::kDst) {
-        GMatrix ctm = matrices.top();
+        if (paint.isAntiAlias()) {
+            fillPathAA(path, matrix, paint);
+            return;
+        }
+
+        // small shared paths drawn with a cached paint: their spans are cached (see
+        // mask_cache.h), and replayed here
+        GRect dev = device_bounds(path.bounds(), matrix);
+        if (paint.isCached() && MaskCache::Wanted(path, dev) && valid_bounds(dev, fDevice.width(), fDevice.height())) {
+            auto mask = MaskCache::Shared().mask(path, matrix, kFlattenTolerance);
+            fillMask(*mask.spans, mask.dx, mask.dy, paint);
+            return;
+        }
+
         std::vector<Edge> edges;
-        
-        // std::cout << "\n=========================\n";
-        get_edges(&edges,path,fDevice.width(),fDevice.height(),ctm);
+        pathEdges(path, matrix, &edges);
     	
         // std::cout << "\nEDGES (" << edges.size() << "): ";
         // for (int i = 0; i < edges.size(); i++) {
@@ -29,235 +53,349 @@ void MyCanvas::drawPath(const GPath& path, const GPaint& paint) {
         // }
         // std::cout << "\n";
 
+        // a single convex contour only ever has two edges per row
+        if (path.isConvex()) {
+            fillConvex(edges, paint);
+            return;
+        }
+
         // if still a polygon...
         if (edges.size() >= 2) {
+            fillEdges(edges, paint);
+        }
+    }
+}
 
-            // get top (first row) and bottom (last row)
-            int top = fDevice.height();
-            int bottom = 0;
-            for (int i = 0; i < edges.size(); i++) {
-                
-                // assign top
-                if (edges[i].top < top) {
-                    top = edges[i].top;
-                }
+/* fillPathAA()
+ * anti-aliased fill (see aa.h): the path's device lines are accumulated in the cells of its
+ * box on the device, then blended with the coverage of each pixel
+ */
+void MyCanvas::fillPathAA(const GPath& path, const GMatrix& ctm, const GPaint& paint) {
+    int width = fDevice.width();
+    int height = fDevice.height();
+    GRect dev = device_bounds(path.bounds(), ctm);
+    if (!(dev.left <= dev.right) || !(dev.top <= dev.bottom) || !valid_bounds(dev, width, height)) {
+        return;
+    }
 
-                // assign bottom
-                if (edges[i].bottom > bottom) {
-                    bottom = edges[i].bottom;
-                }
+    // the path's box, on the device
+    auto clamp = [](float v, int hi) {
+        return int(std::min(std::max(v, 0.0f), float(hi)));
+    };
+    int left = clamp(floor(dev.left), width);
+    int top = clamp(floor(dev.top), height);
+    int right = clamp(ceil(dev.right), width);
+    int bottom = clamp(ceil(dev.bottom), height);
+    if ((left >= right) || (top >= bottom)) {
+        return;
+    }
+
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
+
+    // device lines (see pathEdges()): (offset) moves them onto the device
+    PathCache::Lines lines;
+    GVector offset = {0, 0};
+    if (lod_wanted(path, dev)) {
+        auto simplified = PathCache::Shared().lodLines(path, ctm, kFlattenTolerance, kLODTolerance);
+        std::shared_ptr<GPoint> mapped(new GPoint[simplified.count], std::default_delete<GPoint[]>());
+        ctm.mapPoints(mapped.get(), simplified.pts.get(), int(simplified.count));
+        lines = {mapped, simplified.count};
+    } else if (cull_wanted(dev, width, height)) {
+        auto culled = std::make_shared<std::vector<GPoint>>();
+        flatten_path(culled.get(), path, ctm, kFlattenTolerance, true, width, height);
+        lines = {std::shared_ptr<const GPoint>(culled, culled->data()), culled->size()};
+    } else {
+        lines = PathCache::Shared().lines(path, ctm, kFlattenTolerance);
+        offset = {ctm[4], ctm[5]};
+    }
+
+    // the box is accumulated in bands of rows, limiting the cells to kAACellBudget (a huge
+    // device can have a box much bigger than that)
+    int bandRows = std::max(1, kAACellBudget / (right - left + 2));
+    Blitter blitter = this->makeBlitter(paint);
+    const GPoint* pts = lines.pts.get();
+
+    for (int bandTop = top; bandTop < bottom; bandTop += bandRows) {
+        CoverageAccumulator cells(right - left, std::min(bandRows, bottom - bandTop));
+        GVector moved = offset - GVector{float(left), float(bandTop)};
+        for (size_t i = 0; i + 1 < lines.count; i += 2) {
+            cells.addLine(pts[i] + moved, pts[i + 1] + moved);
+        }
+        cells.blit(left, bandTop, blitter);
+    }
+}
+
+/* fillMask()
+ * replay a path's spans (see MaskCache), moved by (dx, dy) and clipped to the device
+ */
+void MyCanvas::fillMask(const std::vector<MaskSpan>& spans, int dx, int dy, const GPaint& paint) {
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
+
+    int width = fDevice.width();
+    int height = fDevice.height();
+    Blitter blitter = this->makeBlitter(paint);
+
+    for (const MaskSpan& span : spans) {
+        int y = span.y + dy;
+        if ((y >= 0) && (y < height)) {
+            int left = std::max(span.x + dx, 0);
+            int right = std::min(span.x + dx + span.count, width);
+            blitter.blitRow(left, y, right - left);
+        }
+    }
+}
+
+/* drawPathInstances()
+ * the path's lines (see PathCache::lines()) are turned into an edge template (see edge.h) once
+ * per scale/skew, and every instance that lands inside the device just places it at its
+ * translation; instances on the device's border are clipped as usual
+ */
+void MyCanvas::drawPathInstances(const GPath& path, const GMatrix instances[], int count, const GPaint& paint) {
+    if (paint.getBlendMode() == GBlendMode::kDst) {
+        return;
+    }
+
+    int width = fDevice.width();
+    int height = fDevice.height();
+
+    EdgeTemplate tmpl;
+    PathCache::Lines lines = {nullptr, 0};
+    GMatrix linear;
+    bool haveTemplate = false;
+    std::vector<Edge> edges;
+
+    for (int i = 0; i < count; i++) {
+        GMatrix ctm = matrices.top() * instances[i];
+        GRect dev = device_bounds(path.bounds(), ctm);
+        if (!valid_bounds(dev, width, height)) {
+            continue;
+        }
+
+        // simplified or culled paths depend on more than the scale/skew, and anti-aliased
+        // ones aren't scanned from edges
+        if (paint.isAntiAlias() || lod_wanted(path, dev) || cull_wanted(dev, width, height)) {
+            fillPath(path, ctm, paint);
+            continue;
+        }
+
+        // a new scale/skew: a new template
+        if (!haveTemplate || (ctm[0] != linear[0]) || (ctm[1] != linear[1])
+                          || (ctm[2] != linear[2]) || (ctm[3] != linear[3])) {
+            lines = PathCache::Shared().lines(path, ctm, kFlattenTolerance);
+            make_edge_template(&tmpl, lines.pts.get(), lines.count);
+            linear = ctm;
+            haveTemplate = true;
+        }
+
+        // (checked against the lines themselves: the path's bounds may come from a file)
+        edges.clear();
+        GVector offset = {ctm[4], ctm[5]};
+        GRect placed = tmpl.bounds.offset(offset.x, offset.y);
+        if ((placed.left >= 0) && (placed.right < float(width)) && (placed.top >= 0) && (placed.bottom < float(height))) {
+            place_edges(&edges, tmpl, offset);
+        } else {
+            get_edges(&edges, lines.pts.get(), lines.count, offset, width, height);
+        }
+
+        if (path.isConvex()) {
+            fillConvex(edges, paint);
+        } else if (edges.size() >= 2) {
+            fillEdges(edges, paint);
+        }
+    }
+}
+
+/* pathEdges()
+ * add the device edges of the path mapped by (ctm) to (edges), sorting them (with any that
+ * were already there); none if it's off the device
+ */
+void MyCanvas::pathEdges(const GPath& path, const GMatrix& ctm, std::vector<Edge>* edges) {
+    GRect dev = device_bounds(path.bounds(), ctm);
+    if (!valid_bounds(dev, fDevice.width(), fDevice.height())) {
+        return;
+    }
+
+    // far more points than pixels: simplified lines (cached per scale bucket), mapped here
+    if (lod_wanted(path, dev)) {
+        auto lines = PathCache::Shared().lodLines(path, ctm, kFlattenTolerance, kLODTolerance);
+        std::vector<GPoint> mapped(lines.count);
+        ctm.mapPoints(mapped.data(), lines.pts.get(), int(lines.count));
+        get_edges(edges, mapped.data(), mapped.size(), {0, 0}, fDevice.width(), fDevice.height());
+    }
+
+    // much bigger than the device: flattened straight onto the device, culling
+    // off screen curves (not cached, since it depends on the translation)
+    else if (cull_wanted(dev, fDevice.width(), fDevice.height())) {
+        std::vector<GPoint> lines;
+        flatten_path(&lines, path, ctm, kFlattenTolerance, true, fDevice.width(), fDevice.height());
+        get_edges(edges, lines.data(), lines.size(), {0, 0}, fDevice.width(), fDevice.height());
+    }
+
+    // flattened lines are cached per path + scale/skew, then moved by the translation
+    else {
+        auto lines = PathCache::Shared().lines(path, ctm, kFlattenTolerance);
+        get_edges(edges, lines.pts.get(), lines.count, {ctm[4], ctm[5]}, fDevice.width(), fDevice.height());
+    }
+}
+
+/* drawPaths()
+ * every path's edges (tagged with the path they belong to) go into one list, and the rows are
+ * walked once for all of them (see fillEdgesMulti()); anti-aliased paths are filled one at a
+ * time
+ */
+void MyCanvas::drawPaths(const GPath* const paths[], int count, const GPaint& paint) {
+    if (paint.getBlendMode() == GBlendMode::kDst) {
+        return;
+    }
+
+    if (paint.isAntiAlias()) {
+        for (int i = 0; i < count; i++) {
+            if (paths[i] != nullptr) {
+                fillPath(*paths[i], matrices.top(), paint);
             }
+        }
+        return;
+    }
 
-            GPixel* curr_row = nullptr;
-            GShader* shader = paint.peekShader();
-
-            // use shader: paint.peekShader()
-            if (shader) {
-
-                bool validContext = (*shader).setContext(matrices.top());
-                if (validContext) {
-
-                    for (int y = top; y < bottom; y++) {
-                        // std::cout << "\n===== y = " << y << " =====\n";
-                        int i = 0;
-                        int w = 0;
-                        int left, right, count;
-
-                        // for all active edges...
-                        while ((i < edges.size()) && (edges[i].isValid(y))) {
-                            int thisX = int(round(edges[i].eval_x(float(y + 0.5))));
-
-                            // std::cout << "[i = " << i << "]: thisX = " << thisX << "\n";
-
-                            if (w == 0) {
-                                left = thisX;
-                            }
-                            w += edges[i].w;
-                            if (w == 0) {
-                                right = thisX;
-                                count = right - left;
-                                
-                                // std::cout << "\tx = [" << left << "," << right << "]\n";
-
-                                if (left < right && left < fDevice.width()) {
-                                    curr_row = fDevice.getAddr(left,y);
-
-                                    GPixel src[count];
-                                    (*shader).shadeRow(left,y,count,src);
-                                    
-                                    for (int x = 0; x < count; x++) {
-
-                                        // curr_row[x] = GPixel_PackARGB(1,1,0,0);
-                                        // curr_row[x] = src[x];
-                                        // /*
-                                        switch (optBlendMode) {
-                                            case GBlendMode::kClear:
-                                                curr_row[x] = GPixel_PackARGB(0,0,0,0);
-                                                break;
-                                            
-                                            case GBlendMode::kSrc:
-                                                curr_row[x] = src[x];
-                                                break;
-
-                                            case GBlendMode::kSrcOver:
-                                                curr_row[x] = blend_kSrcOver(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kDstOver:
-                                                curr_row[x] = blend_kDstOver(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kSrcIn:
-                                                curr_row[x] = blend_kSrcIn(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kDstIn:
-                                                curr_row[x] = blend_kDstIn(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kSrcOut:
-                                                curr_row[x] = blend_kSrcOut(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kDstOut:
-                                                curr_row[x] = blend_kDstOut(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kSrcATop:
-                                                curr_row[x] = blend_kSrcATop(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kDstATop:
-                                                curr_row[x] = blend_kDstATop(&src[x],&curr_row[x]);
-                                                break;
-
-                                            case GBlendMode::kXor:
-                                                curr_row[x] = blend_kXor(&src[x],&curr_row[x]);
-                                                break;
-                                        }
-                                        // */
-                                    }
-                                }
-
-                            }
-
-                            // check edge validity;
-                            // remove edge from vector if no longer valid
-                            if (edges[i].isValid(y+1)) {
-                                i += 1;
-                            } else {
-                                edges.erase(edges.begin()+i);
-                            }
-                        }
-
-                        // assert(w == 0);
-
-                        while ((i < edges.size()) && (edges[i].isValid(y+1))) {
-                            i += 1;
-                        }
-
-                        std::sort(edges.begin(),edges.begin()+i,[y](const Edge& e1, const Edge& e2) {
-                            return edge_sort_x(e1, e2, y);
-                        });
-
-                    }
-                }
+    // (each path's edges are made on their own: get_edges() sorts all it's given)
+    std::vector<Edge> all;
+    std::vector<Edge> pathOnly;
+    for (int i = 0; i < count; i++) {
+        if (paths[i] == nullptr) {
+            continue;
+        }
+
+        pathOnly.clear();
+        pathEdges(*paths[i], matrices.top(), &pathOnly);
+        for (Edge& e : pathOnly) {
+            e.path = i;
+            all.push_back(e);
+        }
+    }
+    if (all.size() < 2) {
+        return;
+    }
+
+    // the sweep only needs them by top (each path sorts its own crossings): a counting sort
+    // by top keeps the edges starting on a row in path order
+    int height = fDevice.height();
+    std::vector<size_t> starts(height + 1, 0);
+    for (const Edge& e : all) {
+        starts[e.top + 1] += 1;
+    }
+    for (int y = 0; y < height; y++) {
+        starts[y + 1] += starts[y];
+    }
+
+    std::vector<Edge> edges(all.size());
+    for (const Edge& e : all) {
+        edges[starts[e.top]++] = e;
+    }
+    fillEdgesMulti(edges, paint);
+}
+
+/* fillEdges()
+ * fill the region of nonzero winding inside sorted (see edge_sort()) edges (see scan_edges())
+ */
+void MyCanvas::fillEdges(const std::vector<Edge>& edges, const GPaint& paint) {
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
+
+    Blitter blitter = this->makeBlitter(paint);
+    scan_edges(edges, blitter);
+}
+
+/* edge_path_sort()
+ * edges in the order of the paths they belong to
+ */
+static bool edge_path_sort(const Edge& e1, const Edge& e2) {
+    return e1.path < e2.path;
+}
+
+/* fillEdgesMulti()
+ * fill the edges of several paths at once (sorted by top, then by path), each path by its own
+ * nonzero winding (see fillEdges()). The rows are visited once for all the paths: the active
+ * edges are kept grouped by path, so each row only sorts every path's own few crossings, and
+ * each path blits its own runs (where paths overlap, the pixels are blended once for each,
+ * just as if the paths had been drawn one after another).
+ */
+void MyCanvas::fillEdgesMulti(const std::vector<Edge>& edges, const GPaint& paint) {
+    GShader* shader = paint.peekShader();
+    if (shader && !shader->setContext(matrices.top())) {
+        return;
+    }
+
+    int top = edges[0].top;
+    int bottom = 0;
+    for (const Edge& e : edges) {
+        bottom = std::max(bottom, e.bottom);
+    }
+
+    Blitter blitter = this->makeBlitter(paint);
+    std::vector<Edge> active;
+    std::vector<Edge> merged;
+    size_t nextEdge = 0;
+
+    // (x, winding) of each active edge on the row, grouped by path like the active edges
+    std::vector<std::pair<int, int>> crossings;
+
+    for (int y = top; y < bottom; y++) {
+        float y_ray = float(y + 0.5);
+
+        // drop the edges that ended
+        size_t kept = 0;
+        for (size_t i = 0; i < active.size(); i++) {
+            if (active[i].bottom > y) {
+                active[kept++] = active[i];
             }
+        }
+        active.resize(kept);
+
+        // merge in the edges that start (in path order too), keeping them grouped by path
+        size_t start = nextEdge;
+        while ((nextEdge < edges.size()) && (edges[nextEdge].top <= y)) {
+            nextEdge++;
+        }
+        if (nextEdge > start) {
+            merged.clear();
+            std::merge(active.begin(), active.end(), edges.begin() + start, edges.begin() + nextEdge,
+                       std::back_inserter(merged), &edge_path_sort);
+            active.swap(merged);
+        }
 
-            // use color: paint.getColor()
-            else {
-
-                for (int y = top; y < bottom; y++) {
-                    curr_row = fDevice.getAddr(0,y);
-
-                    int i = 0;
-                    int w = 0;
-                    int left, right;
-
-                    // for all active edges...
-                    while ((i < edges.size()) && (edges[i].isValid(y))) {
-                        int thisX = int(round(edges[i].eval_x(float(y + 0.5))));
-                        if (w == 0) {
-                            left = thisX;
-                        }
-
-                        w += edges[i].w;
-                        if (w == 0) {
-                            right = thisX;
-
-                            for (int x = left; x < right; x++) {
-                                
-                                switch (optBlendMode) {
-                                    case GBlendMode::kClear:
-                                        curr_row[x] = GPixel_PackARGB(0,0,0,0);
-                                        break;
-                                    
-                                    case GBlendMode::kSrc:
-                                        curr_row[x] = convertColor2Pixel(paint.getColor());
-                                        break;
-
-                                    case GBlendMode::kSrcOver:
-                                        curr_row[x] = blend_kSrcOver(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kDstOver:
-                                        curr_row[x] = blend_kDstOver(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kSrcIn:
-                                        curr_row[x] = blend_kSrcIn(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kDstIn:
-                                        curr_row[x] = blend_kDstIn(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kSrcOut:
-                                        curr_row[x] = blend_kSrcOut(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kDstOut:
-                                        curr_row[x] = blend_kDstOut(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kSrcATop:
-                                        curr_row[x] = blend_kSrcATop(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kDstATop:
-                                        curr_row[x] = blend_kDstATop(paint.getColor(),&curr_row[x]);
-                                        break;
-
-                                    case GBlendMode::kXor:
-                                        curr_row[x] = blend_kXor(paint.getColor(),&curr_row[x]);
-                                        break;
-                                }
-                                
-                            }
-                        }
-
-                        // check edge validity:
-                        // remove edge from vector if no longer valid
-                        if (edges[i].isValid(y+1)) {
-                            i += 1;
-                        } else {
-                            edges.erase(edges.begin()+i);
-                        }
-                    }
-
-                    // assert(w == 0);
-
-                    while ((i < edges.size()) && (edges[i].isValid(y+1))) {
-                        i += 1;
-                    }
-
-                    std::sort(edges.begin(),edges.begin()+i,[y](const Edge& e1, const Edge& e2) {
-                        return edge_sort_x(e1, e2, y+1);
-                    });
+        crossings.clear();
+        for (const Edge& e : active) {
+            crossings.push_back({int(round(e.eval_x(y_ray))), e.w});
+        }
 
-                }
+        // each path: fill from where its winding leaves 0 to where it comes back
+        for (size_t first = 0; first < active.size();) {
+            size_t last = first + 1;
+            while ((last < active.size()) && (active[last].path == active[first].path)) {
+                last++;
+            }
+            std::sort(crossings.begin() + first, crossings.begin() + last);
 
+            int w = 0;
+            int left = 0;
+            for (size_t i = first; i < last; i++) {
+                if (w == 0) {
+                    left = crossings[i].first;
+                }
+                w += crossings[i].second;
+                if (w == 0) {
+                    blitter.blitRow(left, y, crossings[i].first - left);
+                }
             }
+            first = last;
         }
     }
 }
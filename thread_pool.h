@@ -0,0 +1,134 @@
+#ifndef THREAD_POOL_DEFINED
+#define THREAD_POOL_DEFINED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* ThreadPool
+ * a fixed set of worker threads that run parallelFor() jobs. The calling thread works on
+ * the job too, so a pool with 0 workers simply runs everything inline.
+ *
+ * Only one job runs at a time, and job functions must not call parallelFor() themselves.
+ */
+class ThreadPool {
+public:
+    /* constructor */
+    ThreadPool(int workers) {
+        for (int i = 0; i < workers; i++) {
+            fThreads.emplace_back([this]() { this->workerLoop(); });
+        }
+    }
+
+    /* destructor */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fWake.notify_all();
+        for (std::thread& t : fThreads) {
+            t.join();
+        }
+    }
+
+    /* Shared()
+     * process-wide pool with one thread per core (including the caller)
+     */
+    static ThreadPool& Shared() {
+        static ThreadPool pool(std::max(1, int(std::thread::hardware_concurrency())) - 1);
+        return pool;
+    }
+
+    /* threadCount()
+     * number of threads that work on a job, including the caller
+     */
+    int threadCount() const {
+        return int(fThreads.size()) + 1;
+    }
+
+    /* parallelFor()
+     * call fn(i) for every i in [0, count), spread across the pool; returns when all are done
+     */
+    void parallelFor(int count, const std::function<void(int)>& fn) {
+        if (fThreads.empty() || count <= 1) {
+            for (int i = 0; i < count; i++) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> job(fJobMutex);
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fJob = &fn;
+            fCount = count;
+            fNext = 0;
+            fBusy = int(fThreads.size());
+            fGeneration += 1;
+        }
+        fWake.notify_all();
+
+        run();
+
+        std::unique_lock<std::mutex> lock(fMutex);
+        fDone.wait(lock, [this]() { return fBusy == 0; });
+        fJob = nullptr;
+    }
+
+private:
+    std::vector<std::thread> fThreads;
+
+    std::mutex fJobMutex;
+    std::mutex fMutex;
+    std::condition_variable fWake;
+    std::condition_variable fDone;
+
+    const std::function<void(int)>* fJob = nullptr;
+    int fCount = 0;
+    std::atomic<int> fNext{0};
+    int fBusy = 0;
+    unsigned fGeneration = 0;
+    bool fStop = false;
+
+    /* run()
+     * claim and run indices of the current job until there are none left
+     */
+    void run() {
+        int i;
+        while ((i = fNext++) < fCount) {
+            (*fJob)(i);
+        }
+    }
+
+    /* workerLoop() */
+    void workerLoop() {
+        unsigned seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fWake.wait(lock, [&]() { return fStop || (fGeneration != seen); });
+                if (fStop) {
+                    return;
+                }
+                seen = fGeneration;
+            }
+
+            run();
+
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                fBusy -= 1;
+                if (fBusy == 0) {
+                    fDone.notify_one();
+                }
+            }
+        }
+    }
+};
+
+#endif
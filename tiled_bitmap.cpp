@@ -0,0 +1,89 @@
+#include "include/GTiledBitmap.h"
+
+#include <algorithm>
+
+/* ========== GTiledBitmap ========== */
+
+/* constructor */
+GTiledBitmap::GTiledBitmap(int w, int h, GPixel background) : fTiles(std::make_shared<Tiles>()) {
+    fTiles->width = std::max(w, 0);
+    fTiles->height = std::max(h, 0);
+    fTiles->tilesX = (fTiles->width + kTileSize - 1) / kTileSize;
+    fTiles->tilesY = (fTiles->height + kTileSize - 1) / kTileSize;
+    fTiles->background = background;
+
+    size_t count = size_t(fTiles->tilesX) * size_t(fTiles->tilesY);
+    fTiles->tiles.reset(new std::atomic<GPixel*>[count]);
+    for (size_t i = 0; i < count; i++) {
+        fTiles->tiles[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+/* Tiles destructor */
+GTiledBitmap::Tiles::~Tiles() {
+    size_t count = size_t(tilesX) * size_t(tilesY);
+    for (size_t i = 0; i < count; i++) {
+        delete[] tiles[i].load(std::memory_order_relaxed);
+    }
+}
+
+/* peekTile() */
+GPixel* GTiledBitmap::peekTile(int tx, int ty) const {
+    assert(tx >= 0 && tx < this->tilesX());
+    assert(ty >= 0 && ty < this->tilesY());
+    return fTiles->tiles[size_t(ty) * fTiles->tilesX + tx].load(std::memory_order_acquire);
+}
+
+/* writeTile()
+ * (tiles are checked without the lock first: once allocated, a tile stays until clear())
+ */
+GPixel* GTiledBitmap::writeTile(int tx, int ty) {
+    std::atomic<GPixel*>& slot = fTiles->tiles[size_t(ty) * fTiles->tilesX + tx];
+    GPixel* tile = slot.load(std::memory_order_acquire);
+    if (tile) {
+        return tile;
+    }
+
+    std::lock_guard<std::mutex> lock(fTiles->mutex);
+    tile = slot.load(std::memory_order_acquire);
+    if (!tile) {
+        tile = new GPixel[kTileSize * kTileSize];
+        std::fill(tile, tile + (kTileSize * kTileSize), fTiles->background);
+        slot.store(tile, std::memory_order_release);
+    }
+    return tile;
+}
+
+/* getPixel() */
+GPixel GTiledBitmap::getPixel(int x, int y) const {
+    assert(x >= 0 && x < this->width());
+    assert(y >= 0 && y < this->height());
+    const GPixel* tile = this->peekTile(x / kTileSize, y / kTileSize);
+    if (!tile) {
+        return fTiles->background;
+    }
+    return tile[((y % kTileSize) * kTileSize) + (x % kTileSize)];
+}
+
+/* clear() */
+void GTiledBitmap::clear(GPixel background) {
+    if (!fTiles) {
+        return;
+    }
+
+    size_t count = size_t(fTiles->tilesX) * size_t(fTiles->tilesY);
+    for (size_t i = 0; i < count; i++) {
+        delete[] fTiles->tiles[i].exchange(nullptr);
+    }
+    fTiles->background = background;
+}
+
+/* tileCount() */
+int GTiledBitmap::tileCount() const {
+    int allocated = 0;
+    size_t count = size_t(this->tilesX()) * size_t(this->tilesY());
+    for (size_t i = 0; i < count; i++) {
+        allocated += fTiles->tiles[i].load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    return allocated;
+}
@@ -0,0 +1,277 @@
+#ifndef TRIANGLE_DEFINED
+#define TRIANGLE_DEFINED
+
+#include "simd.h"
+#include "blitter.h"
+#include "include/GPoint.h"
+#include "include/GRect.h"
+
+#include <cmath>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+
+/* ========== HALF-SPACE TRIANGLE RASTERIZER ==========
+ * Each edge (a -> b) of the triangle defines an edge function
+ *      E(p) = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x)
+ * which is >= 0 on the inside of the (counter-clockwise) triangle. A pixel is drawn when
+ * its center is inside all 3 half-spaces.
+ *
+ * Vertices are snapped to 1/16th of a pixel so the edge functions are exact integers, and
+ * pixels exactly on an edge are given to only one of the two triangles sharing that edge
+ * (top-left rule), so meshes have neither gaps nor double-blended seams.
+ */
+
+// number of sub-pixel bits vertices are snapped to
+constexpr int kTriSubBits = 4;
+constexpr int kTriSubOne = 1 << kTriSubBits;
+
+// largest coordinate (in pixels) the rasterizer accepts
+constexpr float kTriMaxCoord = float(1 << 20);
+
+// tile size (pixels) for trivial accept/reject, and the max triangle extent for the tiled path
+constexpr int kTriTileSize = 8;
+constexpr int kTriMaxTiledExtent = 1024;
+
+/* TriEdge
+ * one edge function, in sub-pixel units: direction (dx, dy), start point (ax, ay), and the
+ * bias (0 or -1) that implements the top-left rule
+ */
+struct TriEdge {
+    int64_t dx, dy;
+    int64_t ax, ay;
+    int64_t bias;
+};
+
+/* tri_edge()
+ * set up edge (a -> b); pixels exactly on the edge are only included for "top" or "left" edges
+ */
+inline TriEdge tri_edge(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    TriEdge e;
+    e.dx = bx - ax;
+    e.dy = by - ay;
+    e.ax = ax;
+    e.ay = ay;
+
+    bool topLeft = (e.dy < 0) || ((e.dy == 0) && (e.dx > 0));
+    e.bias = topLeft ? 0 : -1;
+
+    return e;
+}
+
+/* floor_div() */
+inline int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if (((a % b) != 0) && ((a < 0) != (b < 0))) {
+        q -= 1;
+    }
+    return q;
+}
+
+/* tri_row_span()
+ * exactly solve for the pixels [left, right) on row y whose centers satisfy all 3 edges
+ */
+inline void tri_row_span(const TriEdge edges[3], int y, int* left, int* right) {
+    int64_t ys = (int64_t(y) << kTriSubBits) + (kTriSubOne / 2);
+
+    for (int i = 0; i < 3; i++) {
+        const TriEdge& e = edges[i];
+
+        // E(x) = c - (16 * dy * x)
+        int64_t c = (e.dx * (ys - e.ay)) - (e.dy * ((kTriSubOne / 2) - e.ax)) + e.bias;
+        int64_t k = e.dy * kTriSubOne;
+
+        if (k == 0) {
+            if (c < 0) {
+                *right = *left;
+                return;
+            }
+        } else if (k < 0) {
+            // x >= ceil(-c / -k)
+            int64_t l = -floor_div(c, -k);
+            *left = int(std::max<int64_t>(*left, l));
+        } else {
+            // x <= floor(c / k)
+            int64_t r = floor_div(c, k) + 1;
+            *right = int(std::min<int64_t>(*right, r));
+        }
+    }
+}
+
+/* tri_tiled_spans()
+ * compute each row's span by walking 8x8 tiles over the bounding box (bounds), trivially
+ * accepting/rejecting whole tiles, and evaluating partial tiles as 4x4 blocks with SIMD.
+ * The spans are merged into rowL[]/rowR[] (indexed from bounds.top).
+ */
+inline void tri_tiled_spans(const TriEdge edges[3], const GIRect& bounds, int rowL[], int rowR[]) {
+    // evaluate relative to the (tile aligned) origin so everything fits in 32 bits
+    int ox = bounds.left & ~(kTriTileSize - 1);
+    int oy = bounds.top & ~(kTriTileSize - 1);
+
+    int32_t e00[3], stepX[3], stepY[3];
+    for (int i = 0; i < 3; i++) {
+        const TriEdge& e = edges[i];
+        int64_t px = (int64_t(ox) << kTriSubBits) + (kTriSubOne / 2);
+        int64_t py = (int64_t(oy) << kTriSubBits) + (kTriSubOne / 2);
+
+        e00[i] = int32_t((e.dx * (py - e.ay)) - (e.dy * (px - e.ax)) + e.bias);
+        stepX[i] = int32_t(-e.dy * kTriSubOne);
+        stepY[i] = int32_t(e.dx * kTriSubOne);
+    }
+
+    const int last = kTriTileSize - 1;
+
+    for (int ty = oy; ty < bounds.bottom; ty += kTriTileSize) {
+        for (int tx = ox; tx < bounds.right; tx += kTriTileSize) {
+
+            // edge values at the tile's top-left pixel
+            int32_t ec[3];
+            bool reject = false;
+            bool accept = true;
+            for (int i = 0; i < 3; i++) {
+                ec[i] = e00[i] + (stepX[i] * (tx - ox)) + (stepY[i] * (ty - oy));
+
+                int32_t hi = ec[i] + std::max(0, stepX[i] * last) + std::max(0, stepY[i] * last);
+                int32_t lo = ec[i] + std::min(0, stepX[i] * last) + std::min(0, stepY[i] * last);
+
+                if (hi < 0) {
+                    reject = true;
+                }
+                if (lo < 0) {
+                    accept = false;
+                }
+            }
+
+            // trivial reject: the whole tile is outside one of the edges
+            if (reject) {
+                continue;
+            }
+
+            int rowStart = std::max(ty, bounds.top);
+            int rowStop = std::min(ty + kTriTileSize, bounds.bottom);
+
+            // trivial accept: the whole tile is inside all edges
+            if (accept) {
+                for (int y = rowStart; y < rowStop; y++) {
+                    rowL[y - bounds.top] = std::min(rowL[y - bounds.top], tx);
+                    rowR[y - bounds.top] = std::max(rowR[y - bounds.top], tx + kTriTileSize);
+                }
+                continue;
+            }
+
+            // partial: evaluate 4x4 blocks, 4 pixels (one row of the block) at a time
+            for (int by = 0; by < kTriTileSize; by += 4) {
+                for (int bx = 0; bx < kTriTileSize; bx += 4) {
+                    I32x4 lanes[3], dy[3];
+                    for (int i = 0; i < 3; i++) {
+                        int32_t e = ec[i] + (stepX[i] * bx) + (stepY[i] * by);
+                        lanes[i] = I32x4(e, e + stepX[i], e + (2 * stepX[i]), e + (3 * stepX[i]));
+                        dy[i] = I32x4(stepY[i]);
+                    }
+
+                    for (int j = 0; j < 4; j++) {
+                        int y = ty + by + j;
+
+                        // a lane is outside if any edge value is negative
+                        int outside = (lanes[0] | lanes[1] | lanes[2]).signMask();
+                        int inside = ~outside & 0xF;
+
+                        if (inside && (y >= bounds.top) && (y < bounds.bottom)) {
+                            int first = __builtin_ctz(inside);
+                            int final = 31 - __builtin_clz(inside);
+                            rowL[y - bounds.top] = std::min(rowL[y - bounds.top], tx + bx + first);
+                            rowR[y - bounds.top] = std::max(rowR[y - bounds.top], tx + bx + final + 1);
+                        }
+
+                        for (int i = 0; i < 3; i++) {
+                            lanes[i] = lanes[i] + dy[i];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* rasterize_triangle()
+ * scan converts the device-space triangle (pts), limited to the pixels inside (clip),
+ * handing each covered row to the blitter.
+ * Returns false (drawing nothing) if the coordinates are out of the supported range.
+ */
+inline bool rasterize_triangle(const GPoint pts[3], const GIRect& clip, Blitter& blitter) {
+    int64_t X[3], Y[3];
+    for (int i = 0; i < 3; i++) {
+        if (!(std::abs(pts[i].x) < kTriMaxCoord) || !(std::abs(pts[i].y) < kTriMaxCoord)) {
+            return false;
+        }
+        X[i] = std::llround(pts[i].x * kTriSubOne);
+        Y[i] = std::llround(pts[i].y * kTriSubOne);
+    }
+
+    // orient counter-clockwise (positive area); skip degenerate triangles
+    int64_t area = ((X[1] - X[0]) * (Y[2] - Y[0])) - ((Y[1] - Y[0]) * (X[2] - X[0]));
+    if (area == 0) {
+        return true;
+    }
+    if (area < 0) {
+        std::swap(X[1], X[2]);
+        std::swap(Y[1], Y[2]);
+    }
+
+    TriEdge edges[3] = {
+        tri_edge(X[0], Y[0], X[1], Y[1]),
+        tri_edge(X[1], Y[1], X[2], Y[2]),
+        tri_edge(X[2], Y[2], X[0], Y[0]),
+    };
+
+    // pixel bounds of the triangle, limited to the clip
+    int64_t minX = std::min({X[0], X[1], X[2]});
+    int64_t maxX = std::max({X[0], X[1], X[2]});
+    int64_t minY = std::min({Y[0], Y[1], Y[2]});
+    int64_t maxY = std::max({Y[0], Y[1], Y[2]});
+
+    GIRect bounds;
+    bounds.left = std::max(clip.left, int(floor_div(minX, kTriSubOne)));
+    bounds.top = std::max(clip.top, int(floor_div(minY, kTriSubOne)));
+    bounds.right = std::min(clip.right, int(floor_div(maxX, kTriSubOne)) + 1);
+    bounds.bottom = std::min(clip.bottom, int(floor_div(maxY, kTriSubOne)) + 1);
+
+    if (bounds.isEmpty()) {
+        return true;
+    }
+
+    // small triangles: tiles + SIMD blocks (the extent check keeps the edge values in 32 bits)
+    int64_t maxExtent = int64_t(kTriMaxTiledExtent) << kTriSubBits;
+    if (((maxX - minX) <= maxExtent) && ((maxY - minY) <= maxExtent)) {
+        int rowL[kTriMaxTiledExtent + 1];
+        int rowR[kTriMaxTiledExtent + 1];
+        std::fill(rowL, rowL + bounds.height(), INT_MAX);
+        std::fill(rowR, rowR + bounds.height(), INT_MIN);
+
+        tri_tiled_spans(edges, bounds, rowL, rowR);
+
+        for (int y = bounds.top; y < bounds.bottom; y++) {
+            int left = std::max(rowL[y - bounds.top], bounds.left);
+            int right = std::min(rowR[y - bounds.top], bounds.right);
+            if (left < right) {
+                blitter.blitRow(left, y, right - left);
+            }
+        }
+    }
+
+    // large triangles: solve each row's span directly
+    else {
+        for (int y = bounds.top; y < bounds.bottom; y++) {
+            int left = bounds.left;
+            int right = bounds.right;
+            tri_row_span(edges, y, &left, &right);
+            if (left < right) {
+                blitter.blitRow(left, y, right - left);
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif
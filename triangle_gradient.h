@@ -55,14 +55,16 @@ public:
 
     /* shadeRow() */
     void shadeRow(int x, int y, int count, GPixel row[]) {
-        // first point + color
-        GPoint p = mapPoint(x, y);
+        // color at the start of the device row (x = 0), so a pixel's color doesn't depend on
+        // where its span starts (e.g. when a row is split across tiles)
+        GPoint p = mapPoint(0, y);
         GColor c = (p.x * dc1) + (p.y * dc2) + c0;
         
         // for each pixel in row
+        // (pin, since pixel centers near an edge can extrapolate slightly past the vertex colors)
         for (int i = 0; i < count; i++) {
-            row[i] = convertColor2Pixel(c);
-            c += dc;
+            GColor thisColor = c + (float(x + i) * dc);
+            row[i] = convertColor2Pixel(thisColor.pinToUnit());
         }
     }
 